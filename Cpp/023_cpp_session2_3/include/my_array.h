@@ -3,15 +3,38 @@
 // Constructor takes the size
 // has a function read(int index) -> value
 // function write(int index, int value).
+//
+// Array<T>    -> dynamic extent, size given to the constructor, storage on the heap.
+// Array<T, N> -> fixed extent, size is a template parameter, storage inline and
+//                everything constexpr (usable in constant expressions, loops unroll).
 */
+#pragma once  // Header Protection.
+
+#include <cstddef>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+// Extent value meaning "size chosen at run time" (same idea as std::dynamic_extent).
+inline constexpr std::size_t kDynamicExtent = static_cast<std::size_t>(-1);
+
+template <typename T, std::size_t Extent = kDynamicExtent>
+class Array;
 
 template <typename T>
-class Array {
+class Array<T, kDynamicExtent> {
     T *arr;
     int curr_size;
 
    public:
+    // Elements are contiguous, so plain pointers are the iterators (they model std::contiguous_iterator).
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = const T *;
+
     // Disable default constructor
     Array() = delete;
     Array(int size);
@@ -25,6 +48,53 @@ class Array {
     void write(int index, T value);
     T read(int index);
     int get_arr_size();
+    void fill(const T &value);
+
+    // Contiguous range interface: <algorithm>, std::ranges and std::span work on Array directly.
+    T *data();
+    const T *data() const;
+    std::size_t size() const;
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    operator std::span<T>();
+    operator std::span<const T>() const;
+};
+
+template <typename T, std::size_t N>
+class Array {
+    T arr[N == 0 ? 1 : N];  // zero-length arrays are not allowed
+
+   public:
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    // Size is part of the type: default constructor value-initialises the elements.
+    constexpr Array();
+    constexpr Array(std::initializer_list<T> values);
+    // Copying a fixed buffer is cheap, so unlike the dynamic Array it is allowed.
+    constexpr Array(const Array &source) = default;
+    constexpr Array &operator=(const Array &s) = default;
+
+    constexpr T &operator[](int index);
+    constexpr const T &operator[](int index) const;
+
+    constexpr void write(int index, T value);
+    constexpr T read(int index) const;
+    constexpr int get_arr_size() const;
+    constexpr void fill(const T &value);
+
+    constexpr T *data();
+    constexpr const T *data() const;
+    constexpr std::size_t size() const;
+    constexpr iterator begin();
+    constexpr iterator end();
+    constexpr const_iterator begin() const;
+    constexpr const_iterator end() const;
+    constexpr operator std::span<T, N>();
+    constexpr operator std::span<const T, N>() const;
 };
 
 #include <my_array.tpp>
\ No newline at end of file
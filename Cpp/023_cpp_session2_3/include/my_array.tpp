@@ -58,3 +58,176 @@ template <typename T>
 int Array<T>::get_arr_size() {
     return curr_size;
 }
+
+template <typename T>
+void Array<T>::fill(const T &value) {
+    for (int i = 0; i < curr_size; i++) {
+        arr[i] = value;
+    }
+}
+
+template <typename T>
+T *Array<T>::data() {
+    return arr;
+}
+
+template <typename T>
+const T *Array<T>::data() const {
+    return arr;
+}
+
+template <typename T>
+std::size_t Array<T>::size() const {
+    return curr_size;
+}
+
+template <typename T>
+typename Array<T>::iterator Array<T>::begin() {
+    return arr;
+}
+
+template <typename T>
+typename Array<T>::iterator Array<T>::end() {
+    return arr + curr_size;
+}
+
+template <typename T>
+typename Array<T>::const_iterator Array<T>::begin() const {
+    return arr;
+}
+
+template <typename T>
+typename Array<T>::const_iterator Array<T>::end() const {
+    return arr + curr_size;
+}
+
+template <typename T>
+Array<T>::operator std::span<T>() {
+    return std::span<T>(arr, curr_size);
+}
+
+template <typename T>
+Array<T>::operator std::span<const T>() const {
+    return std::span<const T>(arr, curr_size);
+}
+
+// Fixed extent Array<T, N>.
+// Out of range accesses reach std::cout, which is not constexpr, so in a constant
+// expression they become compile errors instead of the run time message.
+
+template <typename T, std::size_t N>
+constexpr Array<T, N>::Array() : arr{} {}
+
+template <typename T, std::size_t N>
+constexpr Array<T, N>::Array(std::initializer_list<T> values) : arr{} {
+    if (values.size() > N) {
+        std::cout << "ERROR: too many initializers\n";
+    }
+    std::size_t i = 0;
+    for (const T &v : values) {
+        if (i == N) break;
+        arr[i++] = v;
+    }
+}
+
+template <typename T, std::size_t N>
+constexpr T &Array<T, N>::operator[](int index) {
+    if (index < 0 || static_cast<std::size_t>(index) >= N) {
+        std::cout << "ERROR: out of bounds access\n";
+        return arr[0];
+    }
+    return arr[index];
+}
+
+template <typename T, std::size_t N>
+constexpr const T &Array<T, N>::operator[](int index) const {
+    if (index < 0 || static_cast<std::size_t>(index) >= N) {
+        std::cout << "ERROR: out of bounds access\n";
+        return arr[0];
+    }
+    return arr[index];
+}
+
+template <typename T, std::size_t N>
+constexpr void Array<T, N>::write(int index, T value) {
+    if (index < 0 || static_cast<std::size_t>(index) >= N) {
+        std::cout << "ERROR: Index out of size !!!" << std::endl;
+        return;
+    }
+    arr[index] = value;
+    if (!std::is_constant_evaluated()) {
+        std::cout << value << " inserted at " << index << " successfully :)" << std::endl;
+    }
+}
+
+template <typename T, std::size_t N>
+constexpr T Array<T, N>::read(int index) const {
+    if (index < 0 || static_cast<std::size_t>(index) >= N) {
+        std::cout << "Invalid Index !!!" << std::endl;
+        return -1;
+    }
+    return arr[index];
+}
+
+template <typename T, std::size_t N>
+constexpr int Array<T, N>::get_arr_size() const {
+    return N;
+}
+
+template <typename T, std::size_t N>
+constexpr void Array<T, N>::fill(const T &value) {
+    for (std::size_t i = 0; i < N; i++) {
+        arr[i] = value;
+    }
+}
+
+template <typename T, std::size_t N>
+constexpr T *Array<T, N>::data() {
+    return arr;
+}
+
+template <typename T, std::size_t N>
+constexpr const T *Array<T, N>::data() const {
+    return arr;
+}
+
+template <typename T, std::size_t N>
+constexpr std::size_t Array<T, N>::size() const {
+    return N;
+}
+
+template <typename T, std::size_t N>
+constexpr typename Array<T, N>::iterator Array<T, N>::begin() {
+    return arr;
+}
+
+template <typename T, std::size_t N>
+constexpr typename Array<T, N>::iterator Array<T, N>::end() {
+    return arr + N;
+}
+
+template <typename T, std::size_t N>
+constexpr typename Array<T, N>::const_iterator Array<T, N>::begin() const {
+    return arr;
+}
+
+template <typename T, std::size_t N>
+constexpr typename Array<T, N>::const_iterator Array<T, N>::end() const {
+    return arr + N;
+}
+
+template <typename T, std::size_t N>
+constexpr Array<T, N>::operator std::span<T, N>() {
+    return std::span<T, N>(arr, N);
+}
+
+template <typename T, std::size_t N>
+constexpr Array<T, N>::operator std::span<const T, N>() const {
+    return std::span<const T, N>(arr, N);
+}
+
+static_assert(std::contiguous_iterator<Array<int>::iterator>);
+static_assert(std::ranges::contiguous_range<Array<int>> && std::ranges::sized_range<Array<int>>);
+static_assert(std::ranges::contiguous_range<const Array<int>>);
+static_assert(std::ranges::contiguous_range<Array<int, 4>> && std::ranges::sized_range<Array<int, 4>>);
+static_assert(Array<int, 4>{1, 2, 3, 4}.read(3) == 4);  // built and read at compile time
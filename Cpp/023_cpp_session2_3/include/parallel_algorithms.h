@@ -0,0 +1,48 @@
+/*
+// Parallel algorithms over contiguous memory (raw pointers or any contiguous range, Array<T> included).
+// All of them run on a work-stealing ThreadPool (default_pool() unless one is passed).
+//  - parallel_for_each(first, last, f)
+//  - parallel_reduce(first, last, init, op)      op must be associative, the result has the type of init
+//  - parallel_merge_sort(first, last, comp)       stable, any strict weak ordering
+//  - parallel_radix_sort(first, last)             integer keys only (LSD, 8 bits per pass)
+*/
+#pragma once  // Header Protection.
+
+#include <thread_pool.h>
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <ranges>
+
+// Below this many elements the algorithms stay on the calling thread.
+constexpr std::size_t kParallelGrain = 1 << 14;
+
+template <typename T, typename F>
+void parallel_for_each(T *first, T *last, F f, ThreadPool &pool = default_pool());
+
+template <typename T, typename U, typename BinaryOp = std::plus<>>
+U parallel_reduce(const T *first, const T *last, U init, BinaryOp op = {}, ThreadPool &pool = default_pool());
+
+template <typename T, typename Compare = std::less<>>
+void parallel_merge_sort(T *first, T *last, Compare comp = {}, ThreadPool &pool = default_pool());
+
+template <std::integral T>
+void parallel_radix_sort(T *first, T *last, ThreadPool &pool = default_pool());
+
+// Overloads for any contiguous range (std::vector, std::array, std::span, Array<T>, ...).
+
+template <std::ranges::contiguous_range R, typename F>
+void parallel_for_each(R &&range, F f, ThreadPool &pool = default_pool());
+
+template <std::ranges::contiguous_range R, typename T, typename BinaryOp = std::plus<>>
+T parallel_reduce(R &&range, T init, BinaryOp op = {}, ThreadPool &pool = default_pool());
+
+template <std::ranges::contiguous_range R, typename Compare = std::less<>>
+void parallel_merge_sort(R &&range, Compare comp = {}, ThreadPool &pool = default_pool());
+
+template <std::ranges::contiguous_range R>
+    requires std::integral<std::ranges::range_value_t<R>>
+void parallel_radix_sort(R &&range, ThreadPool &pool = default_pool());
+
+#include <parallel_algorithms.tpp>
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace parallel_detail {
+
+// Enough chunks to keep every worker busy and let stealing balance uneven ones.
+inline std::size_t chunk_count(std::size_t n, ThreadPool &pool) {
+    if (n <= kParallelGrain) return 1;
+    return std::max<std::size_t>(1, std::min<std::size_t>(n / kParallelGrain, pool.size() * 4));
+}
+
+// Split [0, n) into `chunks` ranges and call fn(chunk, begin, end) for each, chunk 0 on the calling thread.
+template <typename F>
+void run_chunks(std::size_t n, std::size_t chunks, F &&fn, ThreadPool &pool) {
+    std::size_t len = (n + chunks - 1) / chunks;
+    TaskGroup group(pool);
+    for (std::size_t c = 1; c < chunks; c++) {
+        std::size_t begin = std::min(n, c * len);
+        std::size_t end = std::min(n, begin + len);
+        group.run([&fn, c, begin, end] { fn(c, begin, end); });
+    }
+    fn(0, 0, std::min(n, len));
+    group.wait();
+}
+
+// Stable merge of the sorted runs a[0, na) and b[0, nb) into out.
+template <typename T, typename Compare>
+void parallel_merge(T *a, std::size_t na, T *b, std::size_t nb, T *out, Compare &comp, ThreadPool &pool) {
+    if (na + nb <= kParallelGrain) {
+        std::merge(std::make_move_iterator(a), std::make_move_iterator(a + na), std::make_move_iterator(b),
+                   std::make_move_iterator(b + nb), out, comp);
+        return;
+    }
+
+    // Split the longer run in the middle and binary search the split point in the other one.
+    // lower_bound / upper_bound keep equal elements of `a` ahead of those of `b`.
+    std::size_t ma, mb;
+    if (na >= nb) {
+        ma = na / 2;
+        mb = std::lower_bound(b, b + nb, a[ma], comp) - b;
+    } else {
+        mb = nb / 2;
+        ma = std::upper_bound(a, a + na, b[mb], comp) - a;
+    }
+
+    TaskGroup group(pool);
+    group.run([&] { parallel_merge(a, ma, b, mb, out, comp, pool); });
+    parallel_merge(a + ma, na - ma, b + mb, nb - mb, out + ma + mb, comp, pool);
+    group.wait();
+}
+
+// Sort a[0, n) in place, tmp is scratch space of the same length.
+template <typename T, typename Compare>
+void merge_sort(T *a, T *tmp, std::size_t n, Compare &comp, ThreadPool &pool) {
+    if (n <= kParallelGrain) {
+        std::stable_sort(a, a + n, comp);
+        return;
+    }
+
+    std::size_t mid = n / 2;
+    TaskGroup group(pool);
+    group.run([&] { merge_sort(a, tmp, mid, comp, pool); });
+    merge_sort(a + mid, tmp + mid, n - mid, comp, pool);
+    group.wait();
+
+    parallel_merge(a, mid, a + mid, n - mid, tmp, comp, pool);
+    run_chunks(
+        n, chunk_count(n, pool),
+        [&](std::size_t, std::size_t begin, std::size_t end) { std::move(tmp + begin, tmp + end, a + begin); }, pool);
+}
+
+}  // namespace parallel_detail
+
+template <typename T, typename F>
+void parallel_for_each(T *first, T *last, F f, ThreadPool &pool) {
+    std::size_t n = last - first;
+    parallel_detail::run_chunks(
+        n, parallel_detail::chunk_count(n, pool),
+        [&](std::size_t, std::size_t begin, std::size_t end) { std::for_each(first + begin, first + end, f); }, pool);
+}
+
+template <typename T, typename U, typename BinaryOp>
+U parallel_reduce(const T *first, const T *last, U init, BinaryOp op, ThreadPool &pool) {
+    std::size_t n = last - first;
+    std::size_t chunks = parallel_detail::chunk_count(n, pool);
+    if (chunks == 1) return std::accumulate(first, last, init, op);
+
+    // Every chunk folds its own elements (seeded with its first one), then the partials are folded in order.
+    std::vector<U> partial(chunks, init);
+    parallel_detail::run_chunks(
+        n, chunks,
+        [&](std::size_t c, std::size_t begin, std::size_t end) {
+            if (begin < end) partial[c] = std::accumulate(first + begin + 1, first + end, static_cast<U>(first[begin]), op);
+        },
+        pool);
+
+    std::size_t len = (n + chunks - 1) / chunks;
+    U result = init;
+    for (std::size_t c = 0; c < chunks; c++) {
+        if (c * len < n) result = op(result, partial[c]);
+    }
+    return result;
+}
+
+template <typename T, typename Compare>
+void parallel_merge_sort(T *first, T *last, Compare comp, ThreadPool &pool) {
+    std::size_t n = last - first;
+    if (n < 2) return;
+    if (n <= kParallelGrain) {
+        std::stable_sort(first, last, comp);
+        return;
+    }
+
+    std::vector<T> tmp(n);
+    parallel_detail::merge_sort(first, tmp.data(), n, comp, pool);
+}
+
+template <std::integral T>
+void parallel_radix_sort(T *first, T *last, ThreadPool &pool) {
+    using Key = std::make_unsigned_t<T>;
+    // Flipping the sign bit makes two's complement keys order like unsigned ones.
+    constexpr Key sign_flip = std::is_signed_v<T> ? Key(Key(1) << (sizeof(T) * 8 - 1)) : Key(0);
+
+    std::size_t n = last - first;
+    if (n < 2) return;
+
+    std::vector<T> buffer(n);
+    T *src = first;
+    T *dst = buffer.data();
+
+    std::size_t chunks = parallel_detail::chunk_count(n, pool);
+    std::vector<std::array<std::size_t, 256>> counts(chunks);
+
+    for (unsigned shift = 0; shift < sizeof(T) * 8; shift += 8) {
+        auto digit = [shift](T v) { return (static_cast<Key>(static_cast<Key>(v) ^ sign_flip) >> shift) & 0xff; };
+
+        // 1. Per-chunk histograms of this byte.
+        parallel_detail::run_chunks(
+            n, chunks,
+            [&](std::size_t c, std::size_t begin, std::size_t end) {
+                counts[c].fill(0);
+                for (std::size_t i = begin; i < end; i++) counts[c][digit(src[i])]++;
+            },
+            pool);
+
+        // 2. Exclusive prefix sum, digit major and chunk minor, so the scatter stays stable.
+        //    A byte every key shares would move nothing: skip the pass.
+        bool single_bucket = false;
+        std::size_t offset = 0;
+        for (std::size_t d = 0; d < 256 && !single_bucket; d++) {
+            std::size_t bucket = 0;
+            for (std::size_t c = 0; c < chunks; c++) {
+                std::size_t count = counts[c][d];
+                counts[c][d] = offset;
+                offset += count;
+                bucket += count;
+            }
+            single_bucket = (bucket == n);
+        }
+        if (single_bucket) continue;
+
+        // 3. Scatter every chunk to its own slice of each bucket.
+        parallel_detail::run_chunks(
+            n, chunks,
+            [&](std::size_t c, std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++) dst[counts[c][digit(src[i])]++] = src[i];
+            },
+            pool);
+        std::swap(src, dst);
+    }
+
+    if (src != first) {
+        parallel_detail::run_chunks(
+            n, chunks, [&](std::size_t, std::size_t begin, std::size_t end) { std::copy(src + begin, src + end, first + begin); },
+            pool);
+    }
+}
+
+// Contiguous range overloads.
+
+template <std::ranges::contiguous_range R, typename F>
+void parallel_for_each(R &&range, F f, ThreadPool &pool) {
+    auto *first = std::ranges::data(range);
+    parallel_for_each(first, first + std::ranges::size(range), f, pool);
+}
+
+template <std::ranges::contiguous_range R, typename T, typename BinaryOp>
+T parallel_reduce(R &&range, T init, BinaryOp op, ThreadPool &pool) {
+    const auto *first = std::ranges::data(range);
+    return parallel_reduce(first, first + std::ranges::size(range), init, op, pool);
+}
+
+template <std::ranges::contiguous_range R, typename Compare>
+void parallel_merge_sort(R &&range, Compare comp, ThreadPool &pool) {
+    auto *first = std::ranges::data(range);
+    parallel_merge_sort(first, first + std::ranges::size(range), comp, pool);
+}
+
+template <std::ranges::contiguous_range R>
+    requires std::integral<std::ranges::range_value_t<R>>
+void parallel_radix_sort(R &&range, ThreadPool &pool) {
+    auto *first = std::ranges::data(range);
+    parallel_radix_sort(first, first + std::ranges::size(range), pool);
+}
@@ -0,0 +1,71 @@
+/*
+// Work-stealing thread pool.
+// Every worker owns a deque: it pushes / pops its own tasks at the back (LIFO, cache friendly)
+// and idle workers steal from the front of the other deques (FIFO, oldest = biggest task).
+*/
+#pragma once  // Header Protection.
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+   public:
+    // 0 threads means one per core.
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void submit(std::function<void()> task);
+    // Run one queued task on the calling thread, returns false if every deque was empty.
+    bool run_pending_task();
+    unsigned size() const;
+
+   private:
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued{0};
+    std::atomic<unsigned> next_queue{0};
+    std::atomic<bool> stopping{false};
+    std::mutex sleep_lock;
+    std::condition_variable wake_up;
+
+    void worker_loop(unsigned index);
+    bool pop_task(unsigned index, std::function<void()> &task);
+};
+
+// Shared pool used by the parallel algorithms when no pool is passed.
+ThreadPool &default_pool();
+
+// Fork-join helper: run() tasks on the pool, wait() helps executing queued tasks until all of them are done.
+// The first exception thrown by a task is rethrown from wait().
+class TaskGroup {
+   public:
+    explicit TaskGroup(ThreadPool &pool);
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    void run(std::function<void()> task);
+    void wait();
+
+   private:
+    ThreadPool &m_pool;
+    std::atomic<int> pending{0};
+    std::mutex error_lock;
+    std::exception_ptr error;
+};
@@ -1,7 +1,13 @@
 #include <my_array.h>
+#include <parallel_algorithms.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <iterator>
+#include <numeric>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -30,7 +36,85 @@ class Engineer : public Employee {
     std::string team;
 };
 
-int main() {
+// Speedup of the parallel algorithms from 1 to N threads: ./main [elements] (e.g. ./main 1000000000).
+void parallel_benchmark(size_t n) {
+    std::vector<int> input(n);
+    std::mt19937 gen(42);
+    for (auto &x : input) x = static_cast<int>(gen());
+
+    auto time_ms = [](auto &&fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "elements: " << n << std::endl;
+    for (unsigned threads = 1;; threads = std::min(threads * 2, max_threads)) {
+        ThreadPool pool(threads);
+        std::vector<int> v = input;
+        double radix = time_ms([&] { parallel_radix_sort(v, pool); });
+        bool sorted = std::is_sorted(v.begin(), v.end());
+
+        v = input;
+        double merge = time_ms([&] { parallel_merge_sort(v, std::less<>{}, pool); });
+        sorted = sorted && std::is_sorted(v.begin(), v.end());
+
+        long long sum = 0;
+        double reduce = time_ms([&] { sum = parallel_reduce(v, 0LL, std::plus<>{}, pool); });
+
+        std::cout << threads << " threads: radix " << radix << " ms, merge " << merge << " ms, reduce " << reduce
+                  << " ms" << (sorted ? "" : " (NOT SORTED)") << " sum " << sum << std::endl;
+        if (threads == max_threads) break;
+    }
+}
+
+// std::sort / std::transform / std::reduce through Array iterators against the same calls on a raw new[] buffer.
+void iterator_benchmark(int n) {
+    Array<int> arr(n);
+    int *raw = new int[n];
+    std::mt19937 gen(7);
+    for (int i = 0; i < n; i++) raw[i] = arr.data()[i] = static_cast<int>(gen() % 1000);
+
+    auto time_ms = [](auto &&fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    double sort_arr = time_ms([&] { std::sort(arr.begin(), arr.end()); });
+    double sort_raw = time_ms([&] { std::sort(raw, raw + n); });
+    double transform_arr = time_ms([&] { std::transform(arr.begin(), arr.end(), arr.begin(), [](int x) { return x * 3 + 1; }); });
+    double transform_raw = time_ms([&] { std::transform(raw, raw + n, raw, [](int x) { return x * 3 + 1; }); });
+    long long sum_arr = 0, sum_raw = 0;
+    double reduce_arr = time_ms([&] { sum_arr = std::reduce(arr.begin(), arr.end(), 0LL); });
+    double reduce_raw = time_ms([&] { sum_raw = std::reduce(raw, raw + n, 0LL); });
+
+    std::cout << "Array vs raw pointer (" << n << " ints)" << std::endl;
+    std::cout << "sort:      " << sort_arr << " ms / " << sort_raw << " ms" << std::endl;
+    std::cout << "transform: " << transform_arr << " ms / " << transform_raw << " ms" << std::endl;
+    std::cout << "reduce:    " << reduce_arr << " ms / " << reduce_raw << " ms"
+              << (sum_arr == sum_raw ? "" : " (MISMATCH)") << std::endl;
+    delete[] raw;
+}
+
+// Fixed extent Array built entirely at compile time.
+constexpr Array<int, 8> make_squares() {
+    Array<int, 8> squares;
+    for (int i = 0; i < squares.get_arr_size(); i++) squares[i] = i * i;
+    return squares;
+}
+constexpr Array<int, 8> kSquares = make_squares();
+static_assert(kSquares.read(7) == 49);
+
+int main(int argc, char *argv[]) {
+    parallel_benchmark(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000);
+    iterator_benchmark(10000000);
+
+    std::cout << "squares: ";
+    std::copy(kSquares.begin(), kSquares.end(), std::ostream_iterator<int>(std::cout, " "));
+    std::cout << '\n';
+
     // Array my_arr(10);
     // my_arr.write(0, 10);
     // my_arr.write(1, 20);
@@ -81,22 +165,7 @@ int main() {
     // std::copy(my_v.begin(), my_v.end(), std::ostream_iterator<int>(std::cout, " "));
     // std::cout << '\n';
 
-    // std::vector<int>::iterator it = my_v.begin();
-
-    // for (; it != my_v.end(); it++) {
-    //     bool swapped = false;
-    //     std::vector<int>::iterator j = my_v.begin();
-    //     while (j != (my_v.end() - 1)) {
-    //         if (*j > *(j + 1)) {
-    //             int temp = *j;
-    //             *j = *(j + 1);
-    //             *(j + 1) = temp;
-    //             swapped = true;
-    //         }
-    //         ++j;
-    //     }
-    //     if (!swapped) break;
-    // }
+    // parallel_merge_sort(my_v);  // replaces the old hand-written bubble sort
 
     // std::cout << "Vecotr AFter Sorting" << std::endl;
     // std::cout << "to_vector contains: ";
@@ -0,0 +1,137 @@
+#include <thread_pool.h>
+
+// Index of the worker running on this thread, -1 for threads outside any pool.
+static thread_local int current_worker = -1;
+static thread_local ThreadPool *current_pool = nullptr;
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    for (unsigned i = 0; i < threads; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    wake_up.notify_all();
+    for (auto &t : workers) t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    // Workers keep their own sub-tasks local, other threads spread work round-robin.
+    unsigned index = (current_pool == this) ? current_worker : next_queue++ % queues.size();
+    {
+        std::lock_guard<std::mutex> guard(queues[index]->lock);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    queued++;
+
+    // Taking the sleep lock orders this push with a worker checking `queued` before sleeping.
+    { std::lock_guard<std::mutex> guard(sleep_lock); }
+    wake_up.notify_one();
+}
+
+bool ThreadPool::pop_task(unsigned index, std::function<void()> &task) {
+    // Own deque first (newest task), then steal the oldest task of a victim.
+    {
+        std::lock_guard<std::mutex> guard(queues[index]->lock);
+        if (!queues[index]->tasks.empty()) {
+            task = std::move(queues[index]->tasks.back());
+            queues[index]->tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); i++) {
+        WorkQueue &victim = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::run_pending_task() {
+    if (queued == 0) return false;
+
+    unsigned index = (current_pool == this) ? current_worker : next_queue % queues.size();
+    std::function<void()> task;
+    if (!pop_task(index, task)) return false;
+    task();
+    return true;
+}
+
+void ThreadPool::worker_loop(unsigned index) {
+    current_worker = index;
+    current_pool = this;
+
+    while (true) {
+        std::function<void()> task;
+        if (pop_task(index, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(sleep_lock);
+        wake_up.wait(guard, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0) return;
+    }
+}
+
+unsigned ThreadPool::size() const { return workers.size(); }
+
+ThreadPool &default_pool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// TaskGroup
+
+TaskGroup::TaskGroup(ThreadPool &pool) : m_pool(pool) {}
+
+TaskGroup::~TaskGroup() {
+    // Tasks reference the group, never let it go away with work still in flight.
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    pending++;
+    m_pool.submit([this, task = std::move(task)] {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(error_lock);
+            if (!error) error = std::current_exception();
+        }
+        pending--;
+    });
+}
+
+void TaskGroup::wait() {
+    // Help instead of blocking, so nested groups on worker threads cannot deadlock the pool.
+    while (pending > 0) {
+        if (!m_pool.run_pending_task()) std::this_thread::yield();
+    }
+
+    std::lock_guard<std::mutex> guard(error_lock);
+    if (error) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
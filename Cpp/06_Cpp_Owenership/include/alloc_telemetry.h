@@ -0,0 +1,147 @@
+/*
+// Allocation telemetry for ArrayWrapper (and so Array).
+// Per element type: allocation / free counts, bytes, live and peak bytes and a
+// power-of-two size histogram. Build with -DARRAY_TELEMETRY=0 (make TELEMETRY=0)
+// and every hook becomes an empty inline function.
+*/
+#pragma once  // Header Protection.
+
+#ifndef ARRAY_TELEMETRY
+#define ARRAY_TELEMETRY 1
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Bucket k counts allocations of up to 2^k bytes, the last bucket takes everything bigger.
+constexpr int kAllocHistogramBuckets = 40;
+
+struct AllocStats {
+    std::string type_name;
+    std::size_t elem_size = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t frees = 0;
+    std::uint64_t bytes_allocated = 0;
+    std::uint64_t bytes_freed = 0;
+    std::uint64_t live_bytes = 0;
+    std::uint64_t peak_bytes = 0;
+    std::uint64_t histogram[kAllocHistogramBuckets] = {};
+};
+
+#if ARRAY_TELEMETRY
+
+#include <atomic>
+#include <mutex>
+#include <typeinfo>
+
+// Counters owned by one thread for one element type. Only that thread writes them
+// (plain load + store, no locked instruction), readers load them when merging.
+struct AllocThreadCounters {
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> frees{0};
+    std::atomic<std::uint64_t> bytes_allocated{0};
+    std::atomic<std::uint64_t> bytes_freed{0};
+    std::atomic<std::uint64_t> histogram[kAllocHistogramBuckets] = {};
+};
+
+// Everything known about one element type: the live thread blocks plus the totals of exited threads.
+class AllocTypeSlot {
+   public:
+    AllocTypeSlot(const std::type_info &type, std::size_t elem_size);
+    ~AllocTypeSlot();
+
+    void attach(AllocThreadCounters *counters);
+    void detach(AllocThreadCounters *counters);
+    AllocStats merge();
+
+    // A peak of a sum cannot be rebuilt from per-thread counters, so live/peak share one relaxed atomic.
+    void add_live(std::int64_t delta);
+
+   private:
+    const std::type_info &m_type;
+    std::size_t m_elem_size;
+    std::mutex m_lock;
+    std::vector<AllocThreadCounters *> m_threads;
+    AllocStats m_retired;
+    std::atomic<std::int64_t> m_live{0};
+    std::atomic<std::int64_t> m_peak{0};
+};
+
+// Registers a thread's counters with the slot on first use and folds them into it at thread exit.
+class AllocThreadHandle {
+   public:
+    explicit AllocThreadHandle(AllocTypeSlot &slot) : m_slot(slot) { m_slot.attach(&counters); }
+    ~AllocThreadHandle() { m_slot.detach(&counters); }
+
+    AllocThreadCounters counters;
+
+   private:
+    AllocTypeSlot &m_slot;
+};
+
+class AllocTelemetry {
+   public:
+    template <typename T>
+    static void on_alloc(std::size_t count) {
+        record<T>(count, true);
+    }
+    template <typename T>
+    static void on_free(std::size_t count) {
+        record<T>(count, false);
+    }
+
+    // Merge every thread's counters, one entry per element type seen so far.
+    static std::vector<AllocStats> snapshot();
+    static void dump(std::ostream &out = std::cout);
+
+   private:
+    static void bump(std::atomic<std::uint64_t> &counter, std::uint64_t by) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    static int bucket(std::uint64_t bytes) {
+        int b = 0;
+        while (b < kAllocHistogramBuckets - 1 && (std::uint64_t(1) << b) < bytes) b++;
+        return b;
+    }
+
+    template <typename T>
+    static AllocTypeSlot &slot() {
+        static AllocTypeSlot s(typeid(T), sizeof(T));
+        return s;
+    }
+
+    template <typename T>
+    static void record(std::size_t count, bool alloc) {
+        thread_local AllocThreadHandle handle(slot<T>());
+        std::uint64_t bytes = static_cast<std::uint64_t>(count) * sizeof(T);
+        if (alloc) {
+            bump(handle.counters.allocations, 1);
+            bump(handle.counters.bytes_allocated, bytes);
+            bump(handle.counters.histogram[bucket(bytes)], 1);
+            slot<T>().add_live(static_cast<std::int64_t>(bytes));
+        } else {
+            bump(handle.counters.frees, 1);
+            bump(handle.counters.bytes_freed, bytes);
+            slot<T>().add_live(-static_cast<std::int64_t>(bytes));
+        }
+    }
+};
+
+#else  // !ARRAY_TELEMETRY
+
+class AllocTelemetry {
+   public:
+    template <typename T>
+    static void on_alloc(std::size_t) {}
+    template <typename T>
+    static void on_free(std::size_t) {}
+
+    static std::vector<AllocStats> snapshot() { return {}; }
+    static void dump(std::ostream &out = std::cout) { out << "allocation telemetry disabled (ARRAY_TELEMETRY=0)\n"; }
+};
+
+#endif  // ARRAY_TELEMETRY
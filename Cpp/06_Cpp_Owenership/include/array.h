@@ -4,7 +4,45 @@
 // has a function read(int index) -> value
 // function write(int index, int value).
 */
+#pragma once  // Header Protection.
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "alloc_telemetry.h"
+
+// Smallest alignment handed out by the aligned / huge page backings (one cache line).
+constexpr std::size_t kCacheLineSize = 64;
+// Transparent huge page size on x86-64, huge page backed storage is rounded up to it.
+constexpr std::size_t kHugePageSize = 2 * 1024 * 1024;
+
+// Where the ArrayWrapper storage comes from.
+enum class ArrayBacking {
+    Default,  // plain new T[n]
+    Aligned,  // aligned operator new, at least kCacheLineSize
+    HugePage  // anonymous mmap() + madvise(MADV_HUGEPAGE), for multi-gigabyte arrays
+};
+
+struct ArrayOptions {
+    ArrayBacking backing = ArrayBacking::Default;
+    std::size_t alignment = kCacheLineSize;  // must be a power of two, raised to kCacheLineSize
+    // Construct the elements from one thread per core, so on NUMA machines each
+    // page lands on the node of the thread that will later scan it (first touch).
+    // Aligned and HugePage only: Default storage comes from new T[n], which constructs it itself.
+    bool first_touch = false;
+};
 
 // ---- Define ArrayWrapper FIRST (must be a complete type for Array's member) ----
 template <typename T>
@@ -15,44 +53,150 @@ class ArrayWrapper {
     ArrayWrapper &operator=(const ArrayWrapper &) = delete;
 
     ArrayWrapper(int n) {
-        std::cout << "Array Wrapper Called" << std::endl;
         size = n;
         m_arr = new T[n];
+        AllocTelemetry::on_alloc<T>(n);
+    }
+
+    ArrayWrapper(int n, const ArrayOptions &options) : m_options(options) {
+        size = n;
+        if (m_options.backing == ArrayBacking::Default) {
+            if (m_options.first_touch) {
+                throw std::invalid_argument("ArrayWrapper: first_touch needs Aligned or HugePage backing");
+            }
+            m_arr = new T[n];
+            AllocTelemetry::on_alloc<T>(n);
+            return;
+        }
+
+        m_options.alignment = std::max({m_options.alignment, kCacheLineSize, alignof(T)});
+        if ((m_options.alignment & (m_options.alignment - 1)) != 0) {
+            throw std::invalid_argument("ArrayWrapper: alignment must be a power of two");
+        }
+
+        std::size_t bytes = static_cast<std::size_t>(n) * sizeof(T);
+        if (m_options.backing == ArrayBacking::Aligned) {
+            m_arr = static_cast<T *>(::operator new(bytes, std::align_val_t(m_options.alignment)));
+        } else {
+            m_arr = map_huge_pages(bytes);
+        }
+
+        try {
+            construct_elements();
+        } catch (...) {
+            release_storage();
+            throw;
+        }
+        AllocTelemetry::on_alloc<T>(n);
     }
 
     // move constructor
     ArrayWrapper(ArrayWrapper &&other) noexcept {
         size = other.size;
         m_arr = other.m_arr;
+        m_options = other.m_options;
+        mapped_bytes = other.mapped_bytes;
         other.size = 0;
         other.m_arr = nullptr;
+        other.m_options = ArrayOptions{};
+        other.mapped_bytes = 0;
     }
 
     // move assignment
     ArrayWrapper &operator=(ArrayWrapper &&other) noexcept {
         if (this != &other) {
-            delete[] m_arr;
+            release();
             size = other.size;
             m_arr = other.m_arr;
+            m_options = other.m_options;
+            mapped_bytes = other.mapped_bytes;
             other.size = 0;
             other.m_arr = nullptr;
+            other.m_options = ArrayOptions{};
+            other.mapped_bytes = 0;
         }
         return *this;
     }
 
-    ~ArrayWrapper() {
-        std::cout << "Array Wrapper Called" << std::endl;
-        delete[] m_arr;
-    }
+    ~ArrayWrapper() { release(); }
 
     T &operator[](int i) { return m_arr[i]; }
     const T &operator[](int i) const { return m_arr[i]; }  // needed for const access
 
     T &operator*() { return *m_arr; }
 
+    T *data() { return m_arr; }
+    const T *data() const { return m_arr; }
+
+    // Options the storage was really created with (alignment already raised to the minimum).
+    const ArrayOptions &options() const { return m_options; }
+
    private:
     T *m_arr;
     int size;
+    ArrayOptions m_options;
+    std::size_t mapped_bytes = 0;  // length of the mmap() region for ArrayBacking::HugePage
+
+    // Reserve a huge page aligned anonymous mapping and ask for transparent huge pages.
+    T *map_huge_pages(std::size_t bytes) {
+        std::size_t align = std::max(m_options.alignment, kHugePageSize);
+        mapped_bytes = std::max<std::size_t>((bytes + kHugePageSize - 1) / kHugePageSize, 1) * kHugePageSize;
+
+        // Over-map by one alignment unit, then trim the head and tail so the region starts on a huge page.
+        std::size_t reserve = mapped_bytes + align;
+        void *raw = mmap(nullptr, reserve, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        std::uintptr_t start = reinterpret_cast<std::uintptr_t>(raw);
+        std::uintptr_t aligned = (start + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1);
+        std::size_t head = aligned - start;
+        std::size_t tail = reserve - head - mapped_bytes;
+        if (head) munmap(raw, head);
+        if (tail) munmap(reinterpret_cast<void *>(aligned + mapped_bytes), tail);
+
+        // Only a hint: fails harmlessly when THP is disabled, the region then stays on 4K pages.
+        madvise(reinterpret_cast<void *>(aligned), mapped_bytes, MADV_HUGEPAGE);
+        return reinterpret_cast<T *>(aligned);
+    }
+
+    void construct_elements() {
+        if (!m_options.first_touch) {
+            std::uninitialized_default_construct_n(m_arr, size);
+            return;
+        }
+
+        // Value-initialise so even trivial types write (and so fault in) every page of their chunk.
+        unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+        std::size_t chunk = (static_cast<std::size_t>(size) + workers - 1) / workers;
+        std::vector<std::thread> threads;
+        for (unsigned w = 0; w < workers; w++) {
+            std::size_t first = w * chunk;
+            if (first >= static_cast<std::size_t>(size)) break;
+            std::size_t count = std::min(chunk, static_cast<std::size_t>(size) - first);
+            threads.emplace_back([this, first, count] { std::uninitialized_value_construct_n(m_arr + first, count); });
+        }
+        for (auto &t : threads) t.join();
+    }
+
+    void release_storage() {
+        if (m_options.backing == ArrayBacking::Aligned) {
+            ::operator delete(m_arr, std::align_val_t(m_options.alignment));
+        } else if (m_options.backing == ArrayBacking::HugePage) {
+            munmap(m_arr, mapped_bytes);
+        }
+    }
+
+    void release() {
+        if (m_arr == nullptr) return;
+        AllocTelemetry::on_free<T>(size);
+        if (m_options.backing == ArrayBacking::Default) {
+            delete[] m_arr;
+            return;
+        }
+        std::destroy_n(m_arr, size);
+        release_storage();
+    }
 };
 
 // ---- Array comes AFTER the wrapper ----
@@ -62,9 +206,16 @@ class Array {
     int curr_size;
 
    public:
+    // Elements are contiguous, so plain pointers are the iterators (they model std::contiguous_iterator).
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = const T *;
+
     // Disable default constructor
     Array() = delete;
     Array(int size);
+    // Aligned or huge page backed storage, see ArrayOptions.
+    Array(int size, const ArrayOptions &options);
     ~Array();
     // Disable default copy constructor.
     Array(const Array &source) = delete;
@@ -75,4 +226,20 @@ class Array {
     void write(int index, T value);
     T read(int index);
     int get_arr_size();
+
+    // Contiguous range interface: <algorithm>, std::ranges and std::span work on Array directly.
+    // Defined here rather than in array.cpp so they inline into the caller's loops.
+    T *data() { return arr.data(); }
+    const T *data() const { return arr.data(); }
+    std::size_t size() const { return curr_size; }
+    iterator begin() { return arr.data(); }
+    iterator end() { return arr.data() + curr_size; }
+    const_iterator begin() const { return arr.data(); }
+    const_iterator end() const { return arr.data() + curr_size; }
+    operator std::span<T>() { return std::span<T>(arr.data(), curr_size); }
+    operator std::span<const T>() const { return std::span<const T>(arr.data(), curr_size); }
 };
+
+static_assert(std::contiguous_iterator<Array<int>::iterator>);
+static_assert(std::ranges::contiguous_range<Array<int>> && std::ranges::sized_range<Array<int>>);
+static_assert(std::ranges::contiguous_range<const Array<int>>);
@@ -0,0 +1,67 @@
+/*
+// FileArray<T>: persistent Array of trivially copyable T kept in a MappedFile.
+// The file is opened lazily on first access, grows with push_back()/resize(), and
+// flush() makes the content durable. Indexes are size_t so arrays can exceed 2^31 elements.
+*/
+#pragma once  // Header Protection.
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "mapped_file.h"
+
+template <typename T>
+class FileArray {
+    static_assert(std::is_trivially_copyable_v<T>, "FileArray<T> stores raw bytes, T must be trivially copyable");
+
+    MappedFile file;
+
+   public:
+    // Disable default constructor
+    FileArray() = delete;
+    explicit FileArray(std::string path) : file(std::move(path), sizeof(T)) {}
+    // Disable copy (the mapping has a single owner), moving is fine.
+    FileArray(const FileArray &) = delete;
+    FileArray &operator=(const FileArray &) = delete;
+    FileArray(FileArray &&) = default;
+    FileArray &operator=(FileArray &&) = default;
+
+    // [] Operator Overloading, unchecked like ArrayWrapper.
+    T &operator[](std::size_t index) { return data()[index]; }
+
+    void write(std::size_t index, T value) {
+        if (index >= size()) {
+            std::cout << "ERROR: Index out of size !!!" << std::endl;
+            return;
+        }
+        (*this)[index] = value;
+    }
+
+    T read(std::size_t index) {
+        if (index >= size()) {
+            std::cout << "Invalid Index !!!" << std::endl;
+            return T{};
+        }
+        return (*this)[index];
+    }
+
+    void push_back(const T &value) {
+        std::size_t n = size();
+        file.set_count(n + 1);
+        (*this)[n] = value;
+    }
+
+    // New elements are zero bytes (sparse file pages).
+    void resize(std::size_t n) { file.set_count(n); }
+
+    std::size_t size() { return file.count(); }
+    // Contiguous like Array, but the pointers are only valid until the file grows.
+    T *data() { return reinterpret_cast<T *>(file.data()); }
+    T *begin() { return data(); }
+    T *end() { return data() + size(); }
+    void flush() { file.flush(); }
+    bool verify() { return file.verify(); }
+};
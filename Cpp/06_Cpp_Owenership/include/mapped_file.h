@@ -0,0 +1,71 @@
+/*
+// MappedFile: a file of fixed-size records mapped with mmap(MAP_SHARED).
+// Layout: 64-byte header (magic, record size, count, checksum) followed by the records.
+// Nothing is read at open, pages are faulted in on demand, so reopening a huge file is instant.
+*/
+#pragma once  // Header Protection.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct MappedFileHeader {
+    char magic[8];           // "NTIARRAY"
+    std::uint64_t elem_size;  // sizeof(T) of the writer, checked on open
+    std::uint64_t count;      // records in use (the file may hold more capacity)
+    std::uint64_t checksum;   // FNV-1a of the used records, updated by flush()
+    std::uint64_t reserved[4];
+};
+static_assert(sizeof(MappedFileHeader) == 64, "records must start on a cache line");
+
+class MappedFile {
+   public:
+    // Only remembers the path, the file is opened on first use.
+    MappedFile(std::string path, std::size_t elem_size);
+    ~MappedFile();
+
+    // non-copyable (move-only)
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    // Create or open the file and map it. Throws std::system_error / std::runtime_error.
+    void open();
+    bool is_open() const { return m_base != nullptr; }
+
+    // Start of the records, may move after reserve().
+    char *data() {
+        if (!is_open()) open();
+        return m_base + sizeof(MappedFileHeader);
+    }
+    std::size_t count() {
+        if (!is_open()) open();
+        return header()->count;
+    }
+    std::size_t capacity() {
+        if (!is_open()) open();
+        return m_capacity;
+    }
+
+    // Grow the file (ftruncate) and the mapping (mremap) to hold at least n records, new records read as zero.
+    void reserve(std::size_t n);
+    // Set the number of used records, growing the file when needed.
+    void set_count(std::size_t n);
+    // Store the checksum and msync() header and records to disk.
+    void flush();
+    // Recompute the checksum of the records and compare it with the stored one.
+    bool verify();
+
+   private:
+    std::string m_path;
+    std::size_t m_elem_size;
+    int m_fd = -1;
+    char *m_base = nullptr;
+    std::size_t m_mapped = 0;  // bytes currently mapped (header + capacity records)
+    std::size_t m_capacity = 0;
+
+    MappedFileHeader *header() { return reinterpret_cast<MappedFileHeader *>(m_base); }
+    std::uint64_t compute_checksum();
+    void close();
+};
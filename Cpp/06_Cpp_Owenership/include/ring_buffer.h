@@ -0,0 +1,170 @@
+/*
+// Bounded lock-free queues built on ArrayWrapper storage.
+//  - SpscRing<T>: one producer thread, one consumer thread, every operation wait-free.
+//  - MpmcRing<T>: any number of producers and consumers, per-slot sequence numbers
+//                 (D. Vyukov's bounded MPMC queue), lock-free.
+// Capacity is rounded up to a power of two. The producer and consumer indexes live on
+// separate cache lines so the two sides do not invalidate each other's line on every operation.
+*/
+#pragma once  // Header Protection.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "array.h"
+
+inline std::size_t ring_capacity(std::size_t requested) {
+    std::size_t capacity = 2;
+    while (capacity < requested) capacity <<= 1;
+    return capacity;
+}
+
+inline ArrayOptions ring_storage_options() {
+    ArrayOptions options;
+    options.backing = ArrayBacking::Aligned;
+    return options;
+}
+
+template <typename T>
+class SpscRing {
+   public:
+    explicit SpscRing(std::size_t capacity)
+        : slots(static_cast<int>(ring_capacity(capacity)), ring_storage_options()), mask(ring_capacity(capacity) - 1) {}
+
+    // non-copyable (the indexes are shared with other threads)
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    // Producer side.
+    bool try_push(T value) { return push_batch(&value, 1) == 1; }
+
+    // Moves up to n items in, returns how many fitted. One release store publishes them all.
+    std::size_t push_batch(T *items, std::size_t n) {
+        std::size_t t = producer.index.load(std::memory_order_relaxed);
+        std::size_t free = capacity() - (t - producer.cached);
+        if (free < n) {
+            producer.cached = consumer.index.load(std::memory_order_acquire);
+            free = capacity() - (t - producer.cached);
+        }
+        if (n > free) n = free;
+        for (std::size_t i = 0; i < n; i++) slots[static_cast<int>((t + i) & mask)] = std::move(items[i]);
+        producer.index.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer side.
+    bool try_pop(T &out) { return pop_batch(&out, 1) == 1; }
+
+    std::size_t pop_batch(T *out, std::size_t n) {
+        std::size_t h = consumer.index.load(std::memory_order_relaxed);
+        std::size_t ready = consumer.cached - h;
+        if (ready < n) {
+            consumer.cached = producer.index.load(std::memory_order_acquire);
+            ready = consumer.cached - h;
+        }
+        if (n > ready) n = ready;
+        for (std::size_t i = 0; i < n; i++) out[i] = std::move(slots[static_cast<int>((h + i) & mask)]);
+        consumer.index.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    std::size_t capacity() const { return mask + 1; }
+
+   private:
+    // Each side's index plus its cached copy of the other side's index, one cache line per side.
+    struct alignas(kCacheLineSize) Side {
+        std::atomic<std::size_t> index{0};
+        std::size_t cached = 0;
+    };
+
+    ArrayWrapper<T> slots;
+    std::size_t mask;
+    Side producer;
+    Side consumer;
+};
+
+template <typename T>
+class MpmcRing {
+   public:
+    explicit MpmcRing(std::size_t capacity)
+        : cells(static_cast<int>(ring_capacity(capacity)), ring_storage_options()), mask(ring_capacity(capacity) - 1) {
+        // Cell i is free for the producer that claims position i.
+        for (std::size_t i = 0; i <= mask; i++) cells[static_cast<int>(i)].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // non-copyable (the indexes are shared with other threads)
+    MpmcRing(const MpmcRing &) = delete;
+    MpmcRing &operator=(const MpmcRing &) = delete;
+
+    bool try_push(T value) { return push_batch(&value, 1) == 1; }
+    bool try_pop(T &out) { return pop_batch(&out, 1) == 1; }
+
+    // Claims a run of consecutive free cells with a single CAS on the tail, then fills them.
+    std::size_t push_batch(T *items, std::size_t n) {
+        if (n == 0) return 0;
+        std::size_t pos = tail.index.load(std::memory_order_relaxed);
+        std::size_t claimed;
+        while (true) {
+            claimed = 0;
+            while (claimed < n && cell(pos + claimed).sequence.load(std::memory_order_acquire) == pos + claimed) claimed++;
+            if (claimed == 0) {
+                // Either full, or another producer moved the tail: re-read before giving up.
+                std::size_t seq = cell(pos).sequence.load(std::memory_order_acquire);
+                if (static_cast<std::intptr_t>(seq - pos) < 0) return 0;
+                pos = tail.index.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (tail.index.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) break;
+        }
+        for (std::size_t i = 0; i < claimed; i++) {
+            Cell &c = cell(pos + i);
+            c.value = std::move(items[i]);
+            c.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return claimed;
+    }
+
+    std::size_t pop_batch(T *out, std::size_t n) {
+        if (n == 0) return 0;
+        std::size_t pos = head.index.load(std::memory_order_relaxed);
+        std::size_t claimed;
+        while (true) {
+            claimed = 0;
+            while (claimed < n && cell(pos + claimed).sequence.load(std::memory_order_acquire) == pos + claimed + 1) claimed++;
+            if (claimed == 0) {
+                std::size_t seq = cell(pos).sequence.load(std::memory_order_acquire);
+                if (static_cast<std::intptr_t>(seq - (pos + 1)) < 0) return 0;
+                pos = head.index.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (head.index.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) break;
+        }
+        for (std::size_t i = 0; i < claimed; i++) {
+            Cell &c = cell(pos + i);
+            out[i] = std::move(c.value);
+            // Free the cell for the producer one lap later.
+            c.sequence.store(pos + i + mask + 1, std::memory_order_release);
+        }
+        return claimed;
+    }
+
+    std::size_t capacity() const { return mask + 1; }
+
+   private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+    struct alignas(kCacheLineSize) Index {
+        std::atomic<std::size_t> index{0};
+    };
+
+    Cell &cell(std::size_t pos) { return cells[static_cast<int>(pos & mask)]; }
+
+    ArrayWrapper<Cell> cells;
+    std::size_t mask;
+    Index tail;
+    Index head;
+};
@@ -0,0 +1,151 @@
+/*
+// SoA<Fields...>: structure-of-arrays container.
+// Every field lives in its own contiguous ArrayWrapper column, so scanning one field
+// touches only that field's cache lines. Rows are still reachable through RowRef,
+// a proxy that behaves like a tuple of references:
+//
+//     SoA<std::string, double> users(100);
+//     users[3] = {"Mohamed", 2000.0};
+//     auto [name, balance] = users[3];   // name / balance are references into the columns
+//     double total = 0;
+//     for (double b : users.column<1>()) total += b;
+*/
+#pragma once  // Header Protection.
+
+#include <cstddef>
+#include <iostream>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "array.h"
+
+template <typename... Fields>
+class SoA;
+
+// Row proxy: get<I>() returns a reference into column I of the row.
+template <typename... Fields>
+class SoARow {
+   public:
+    using value_type = std::tuple<Fields...>;
+    template <std::size_t I>
+    using field_type = std::tuple_element_t<I, value_type>;
+
+    SoARow(SoA<Fields...> &soa, int row) : m_soa(soa), m_row(row) {}
+
+    template <std::size_t I>
+    field_type<I> &get() const {
+        return std::get<I>(m_soa.columns)[m_row];
+    }
+
+    // Copy a whole row in or out.
+    SoARow &operator=(const value_type &values) {
+        assign(values, std::index_sequence_for<Fields...>{});
+        return *this;
+    }
+    operator value_type() const { return load(std::index_sequence_for<Fields...>{}); }
+
+   private:
+    SoA<Fields...> &m_soa;
+    int m_row;
+
+    template <std::size_t... I>
+    void assign(const value_type &values, std::index_sequence<I...>) {
+        ((get<I>() = std::get<I>(values)), ...);
+    }
+    template <std::size_t... I>
+    value_type load(std::index_sequence<I...>) const {
+        return value_type(get<I>()...);
+    }
+};
+
+template <typename... Fields>
+class SoA {
+    static_assert(sizeof...(Fields) > 0, "SoA needs at least one field");
+
+   public:
+    template <std::size_t I>
+    using field_type = std::tuple_element_t<I, std::tuple<Fields...>>;
+    using value_type = std::tuple<Fields...>;
+    using RowRef = SoARow<Fields...>;
+
+    class iterator {
+       public:
+        iterator(SoA &soa, int row) : m_soa(&soa), m_row(row) {}
+        RowRef operator*() const { return RowRef(*m_soa, m_row); }
+        iterator &operator++() {
+            m_row++;
+            return *this;
+        }
+        bool operator==(const iterator &other) const { return m_row == other.m_row; }
+
+       private:
+        SoA *m_soa;
+        int m_row;
+    };
+
+    // Disable default constructor
+    SoA() = delete;
+    // Columns are cache-line aligned so whole-column loops can vectorise.
+    explicit SoA(int size) : columns(ArrayWrapper<Fields>(size, column_options())...), curr_size(size) {}
+    // Disable copy, the columns are move-only like ArrayWrapper.
+    SoA(const SoA &) = delete;
+    SoA &operator=(const SoA &) = delete;
+
+    RowRef operator[](int row) {
+        if (row < 0 || row >= curr_size) {
+            std::cout << "ERROR: out of bounds access\n";
+            return RowRef(*this, 0);
+        }
+        return RowRef(*this, row);
+    }
+
+    void write(int row, const value_type &values) {
+        if (row < 0 || row >= curr_size) {
+            std::cout << "ERROR: Index out of size !!!" << std::endl;
+            return;
+        }
+        RowRef(*this, row) = values;
+    }
+
+    value_type read(int row) {
+        if (row < 0 || row >= curr_size) {
+            std::cout << "Invalid Index !!!" << std::endl;
+            return value_type{};
+        }
+        return RowRef(*this, row);
+    }
+
+    // Contiguous view of one field.
+    template <std::size_t I>
+    std::span<field_type<I>> column() {
+        return std::span<field_type<I>>(std::get<I>(columns).data(), curr_size);
+    }
+
+    int get_arr_size() { return curr_size; }
+    std::size_t size() const { return curr_size; }
+    iterator begin() { return iterator(*this, 0); }
+    iterator end() { return iterator(*this, curr_size); }
+
+   private:
+    friend class SoARow<Fields...>;
+
+    std::tuple<ArrayWrapper<Fields>...> columns;
+    int curr_size;
+
+    static ArrayOptions column_options() {
+        ArrayOptions options;
+        options.backing = ArrayBacking::Aligned;
+        return options;
+    }
+};
+
+// Tuple protocol for SoARow, so structured bindings give references into the columns.
+template <typename... Fields>
+struct std::tuple_size<SoARow<Fields...>> : std::integral_constant<std::size_t, sizeof...(Fields)> {};
+
+template <std::size_t I, typename... Fields>
+struct std::tuple_element<I, SoARow<Fields...>> {
+    using type = std::tuple_element_t<I, std::tuple<Fields...>> &;
+};
@@ -0,0 +1,107 @@
+#include "alloc_telemetry.h"
+
+#if ARRAY_TELEMETRY
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+
+// Every element type that allocated at least once, for snapshot().
+static std::mutex &registry_lock() {
+    static std::mutex lock;
+    return lock;
+}
+
+static std::vector<AllocTypeSlot *> &registry() {
+    static std::vector<AllocTypeSlot *> slots;
+    return slots;
+}
+
+static std::string demangle(const char *name) {
+    int status = 0;
+    char *readable = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    std::string result = (status == 0 && readable) ? readable : name;
+    std::free(readable);
+    return result;
+}
+
+static void add_counters(AllocStats &into, const AllocThreadCounters &from) {
+    into.allocations += from.allocations.load(std::memory_order_relaxed);
+    into.frees += from.frees.load(std::memory_order_relaxed);
+    into.bytes_allocated += from.bytes_allocated.load(std::memory_order_relaxed);
+    into.bytes_freed += from.bytes_freed.load(std::memory_order_relaxed);
+    for (int b = 0; b < kAllocHistogramBuckets; b++) {
+        into.histogram[b] += from.histogram[b].load(std::memory_order_relaxed);
+    }
+}
+
+// AllocTypeSlot
+
+AllocTypeSlot::AllocTypeSlot(const std::type_info &type, std::size_t elem_size) : m_type(type), m_elem_size(elem_size) {
+    std::lock_guard<std::mutex> guard(registry_lock());
+    registry().push_back(this);
+}
+
+AllocTypeSlot::~AllocTypeSlot() {
+    std::lock_guard<std::mutex> guard(registry_lock());
+    auto &slots = registry();
+    slots.erase(std::remove(slots.begin(), slots.end(), this), slots.end());
+}
+
+void AllocTypeSlot::attach(AllocThreadCounters *counters) {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_threads.push_back(counters);
+}
+
+void AllocTypeSlot::detach(AllocThreadCounters *counters) {
+    std::lock_guard<std::mutex> guard(m_lock);
+    add_counters(m_retired, *counters);
+    m_threads.erase(std::remove(m_threads.begin(), m_threads.end(), counters), m_threads.end());
+}
+
+void AllocTypeSlot::add_live(std::int64_t delta) {
+    std::int64_t live = m_live.fetch_add(delta, std::memory_order_relaxed) + delta;
+    std::int64_t peak = m_peak.load(std::memory_order_relaxed);
+    while (live > peak && !m_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+AllocStats AllocTypeSlot::merge() {
+    std::lock_guard<std::mutex> guard(m_lock);
+    AllocStats stats = m_retired;
+    for (AllocThreadCounters *counters : m_threads) add_counters(stats, *counters);
+    stats.type_name = demangle(m_type.name());
+    stats.elem_size = m_elem_size;
+    stats.live_bytes = std::max<std::int64_t>(0, m_live.load(std::memory_order_relaxed));
+    stats.peak_bytes = std::max<std::int64_t>(0, m_peak.load(std::memory_order_relaxed));
+    return stats;
+}
+
+// AllocTelemetry
+
+std::vector<AllocStats> AllocTelemetry::snapshot() {
+    std::vector<AllocTypeSlot *> slots;
+    {
+        std::lock_guard<std::mutex> guard(registry_lock());
+        slots = registry();
+    }
+    std::vector<AllocStats> result;
+    for (AllocTypeSlot *slot : slots) result.push_back(slot->merge());
+    return result;
+}
+
+void AllocTelemetry::dump(std::ostream &out) {
+    for (const AllocStats &s : snapshot()) {
+        out << "Array<" << s.type_name << "> (" << s.elem_size << " bytes/elem): " << s.allocations << " allocs, "
+            << s.frees << " frees, " << s.bytes_allocated << " bytes allocated, live " << s.live_bytes << " bytes, peak "
+            << s.peak_bytes << " bytes\n";
+        for (int b = 0; b < kAllocHistogramBuckets; b++) {
+            if (s.histogram[b] == 0) continue;
+            out << "    <= 2^" << std::setw(2) << b << " bytes: " << s.histogram[b] << "\n";
+        }
+    }
+}
+
+#endif  // ARRAY_TELEMETRY
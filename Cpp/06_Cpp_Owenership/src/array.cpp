@@ -5,6 +5,9 @@
 template <typename T>
 Array<T>::Array(int size) : arr(size), curr_size(size) {}
 
+template <typename T>
+Array<T>::Array(int size, const ArrayOptions &options) : arr(size, options), curr_size(size) {}
+
 template <typename T>
 Array<T>::~Array() {}
 
@@ -13,8 +16,8 @@ Array<T> &Array<T>::operator=(const Array<T> &s) {
     // Ensure not assigning to myself.
     if (&s == this) return *this;
 
-    // Allocate a temporary wrapper with the right size
-    ArrayWrapper<T> tmp(s.curr_size);
+    // Allocate a temporary wrapper with the right size (and the same backing as the source)
+    ArrayWrapper<T> tmp(s.curr_size, s.arr.options());
 
     // Deep copy elements
     for (int i = 0; i < s.curr_size; i++) {
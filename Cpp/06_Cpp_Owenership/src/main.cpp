@@ -1,7 +1,17 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "array.h"
+#include "file_array.h"
+#include "ring_buffer.h"
+#include "soa.h"
 
 class A {
    public:
@@ -24,8 +34,144 @@ std::unique_ptr<A> foo() {
     return p;
 }
 
+// Scan benchmark: sum the same number of ints stored with each ArrayBacking.
+void scan_benchmark(int n) {
+    const char* names[] = {"default", "aligned", "huge page"};
+    ArrayBacking backings[] = {ArrayBacking::Default, ArrayBacking::Aligned, ArrayBacking::HugePage};
+
+    for (int b = 0; b < 3; b++) {
+        ArrayOptions options;
+        options.backing = backings[b];
+        options.first_touch = backings[b] != ArrayBacking::Default;  // new T[n] places its own pages
+        Array<int> arr(n, options);
+        int* data = arr.data();
+        for (int i = 0; i < n; i++) data[i] = i & 0xff;
+
+        auto start = std::chrono::steady_clock::now();
+        long long sum = 0;
+        for (int i = 0; i < n; i++) sum += data[i];
+        auto end = std::chrono::steady_clock::now();
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << names[b] << " scan: " << ms << " ms (sum " << sum << ")" << std::endl;
+    }
+}
+
+// Persistent array: every run appends to numbers.arr, the previous values are still there.
+void file_array_demo() {
+    FileArray<int> numbers("numbers.arr");
+    std::cout << "numbers.arr holds " << numbers.size() << " values, checksum "
+              << (numbers.verify() ? "ok" : "BAD") << std::endl;
+    for (int i = 0; i < 10; i++) numbers.push_back(static_cast<int>(numbers.size()));
+    numbers.flush();
+    std::cout << "last value: " << numbers.read(numbers.size() - 1) << std::endl;
+}
+
+// Queue benchmark: every item is its push time, consumers measure latency on pop.
+template <typename Queue>
+void queue_benchmark(const char* name, Queue& queue, int producers, int consumers, long items_per_producer) {
+    using Clock = std::chrono::steady_clock;
+    const long total = items_per_producer * producers;
+    std::atomic<long> popped{0};
+    std::atomic<std::int64_t> latency_sum{0};
+    std::atomic<std::int64_t> latency_max{0};
+
+    auto now_ns = [] { return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count(); };
+
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&] {
+            std::int64_t batch[32];
+            for (long sent = 0; sent < items_per_producer;) {
+                std::size_t n = std::min<long>(32, items_per_producer - sent);
+                for (std::size_t i = 0; i < n; i++) batch[i] = now_ns();
+                std::size_t done = 0;
+                while (done < n) {
+                    std::size_t pushed = queue.push_batch(batch + done, n - done);
+                    if (pushed == 0) std::this_thread::yield();
+                    done += pushed;
+                }
+                sent += n;
+            }
+        });
+    }
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&] {
+            std::int64_t batch[32];
+            std::int64_t sum = 0, worst = 0;
+            while (popped.load(std::memory_order_relaxed) < total) {
+                std::size_t n = queue.pop_batch(batch, 32);
+                if (n == 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                std::int64_t t = now_ns();
+                for (std::size_t i = 0; i < n; i++) {
+                    sum += t - batch[i];
+                    worst = std::max(worst, t - batch[i]);
+                }
+                popped.fetch_add(n, std::memory_order_relaxed);
+            }
+            latency_sum += sum;
+            std::int64_t prev = latency_max.load();
+            while (worst > prev && !latency_max.compare_exchange_weak(prev, worst)) {
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << name << " " << producers << "P/" << consumers << "C: " << total / seconds / 1e6 << " Mitems/s, latency avg "
+              << latency_sum / total << " ns, max " << latency_max << " ns" << std::endl;
+}
+
+// One-column scan: wallet-style records as an array of structs against the same data in an SoA.
+struct UserRecord {
+    std::string username;
+    std::string password;
+    double balance;
+};
+
+void soa_benchmark(int n) {
+    std::vector<UserRecord> aos(n);
+    SoA<std::string, std::string, double> soa(n);
+    for (int i = 0; i < n; i++) {
+        aos[i] = {"user" + std::to_string(i), "secret", static_cast<double>(i % 1000)};
+        soa[i] = {aos[i].username, aos[i].password, aos[i].balance};
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    double aos_total = 0;
+    for (const UserRecord& u : aos) aos_total += u.balance;
+    auto middle = std::chrono::steady_clock::now();
+    double soa_total = 0;
+    for (double balance : soa.column<2>()) soa_total += balance;
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "balance scan over " << n << " users: AoS " << std::chrono::duration<double, std::milli>(middle - start).count()
+              << " ms, SoA " << std::chrono::duration<double, std::milli>(end - middle).count() << " ms"
+              << (aos_total == soa_total ? "" : " (MISMATCH)") << std::endl;
+}
+
 int main() {
     std::unique_ptr<A> a = foo();
     a->print();
+
+    scan_benchmark(1 << 26);
+    file_array_demo();
+
+    {
+        SpscRing<std::int64_t> spsc(1024);
+        queue_benchmark("spsc", spsc, 1, 1, 1000000);
+        for (int threads : {1, 2, 4}) {
+            MpmcRing<std::int64_t> mpmc(1024);
+            queue_benchmark("mpmc", mpmc, threads, threads, 1000000 / threads);
+        }
+    }
+
+    soa_benchmark(1000000);
+
+    AllocTelemetry::dump();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+static const char kMagic[8] = {'N', 'T', 'I', 'A', 'R', 'R', 'A', 'Y'};
+// FNV-1a 64 bit offset basis, also the checksum of an empty array.
+static const std::uint64_t kFnvOffset = 14695981039346656037ull;
+static const std::uint64_t kFnvPrime = 1099511628211ull;
+
+MappedFile::MappedFile(std::string path, std::size_t elem_size) : m_path(std::move(path)), m_elem_size(elem_size) {}
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : m_path(std::move(other.m_path)),
+      m_elem_size(other.m_elem_size),
+      m_fd(other.m_fd),
+      m_base(other.m_base),
+      m_mapped(other.m_mapped),
+      m_capacity(other.m_capacity) {
+    other.m_fd = -1;
+    other.m_base = nullptr;
+    other.m_mapped = 0;
+    other.m_capacity = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        close();
+        m_path = std::move(other.m_path);
+        m_elem_size = other.m_elem_size;
+        m_fd = other.m_fd;
+        m_base = other.m_base;
+        m_mapped = other.m_mapped;
+        m_capacity = other.m_capacity;
+        other.m_fd = -1;
+        other.m_base = nullptr;
+        other.m_mapped = 0;
+        other.m_capacity = 0;
+    }
+    return *this;
+}
+
+void MappedFile::open() {
+    if (is_open()) return;
+
+    int fd = ::open(m_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) throw std::system_error(errno, std::generic_category(), "open " + m_path);
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(), "fstat " + m_path);
+    }
+
+    std::size_t file_size = st.st_size;
+    if (file_size == 0) {
+        // Fresh file: write an empty header.
+        MappedFileHeader h{};
+        std::memcpy(h.magic, kMagic, sizeof(kMagic));
+        h.elem_size = m_elem_size;
+        h.checksum = kFnvOffset;
+        if (pwrite(fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h))) {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "write header " + m_path);
+        }
+        file_size = sizeof(h);
+    } else {
+        MappedFileHeader h;
+        if (file_size < sizeof(h) || pread(fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)) ||
+            std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0) {
+            ::close(fd);
+            throw std::runtime_error(m_path + ": not an array file");
+        }
+        if (h.elem_size != m_elem_size) {
+            ::close(fd);
+            throw std::runtime_error(m_path + ": element size mismatch");
+        }
+        if (h.count > (file_size - sizeof(h)) / m_elem_size) {
+            ::close(fd);
+            throw std::runtime_error(m_path + ": truncated file");
+        }
+    }
+
+    void *base = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(), "mmap " + m_path);
+    }
+
+    m_fd = fd;
+    m_base = static_cast<char *>(base);
+    m_mapped = file_size;
+    m_capacity = (file_size - sizeof(MappedFileHeader)) / m_elem_size;
+}
+
+void MappedFile::reserve(std::size_t n) {
+    if (!is_open()) open();
+    if (n <= m_capacity) return;
+
+    // Grow geometrically so repeated appends stay amortised O(1).
+    std::size_t new_capacity = std::max(n, m_capacity + m_capacity / 2);
+    std::size_t new_size = sizeof(MappedFileHeader) + new_capacity * m_elem_size;
+    if (ftruncate(m_fd, new_size) < 0) throw std::system_error(errno, std::generic_category(), "ftruncate " + m_path);
+
+    void *base = mremap(m_base, m_mapped, new_size, MREMAP_MAYMOVE);
+    if (base == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "mremap " + m_path);
+
+    m_base = static_cast<char *>(base);
+    m_mapped = new_size;
+    m_capacity = new_capacity;
+}
+
+void MappedFile::set_count(std::size_t n) {
+    reserve(n);
+    header()->count = n;
+}
+
+// FNV-1a over 8-byte words (bytes for the tail), this is the only full pass over the records.
+std::uint64_t MappedFile::compute_checksum() {
+    std::uint64_t hash = kFnvOffset;
+    const char *p = data();
+    std::size_t bytes = header()->count * m_elem_size;
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= bytes; i += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, p + i, sizeof(word));
+        hash ^= word;
+        hash *= kFnvPrime;
+    }
+    for (; i < bytes; i++) {
+        hash ^= static_cast<unsigned char>(p[i]);
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+void MappedFile::flush() {
+    if (!is_open()) return;
+    header()->checksum = compute_checksum();
+    if (msync(m_base, m_mapped, MS_SYNC) < 0) throw std::system_error(errno, std::generic_category(), "msync " + m_path);
+}
+
+bool MappedFile::verify() {
+    if (!is_open()) open();
+    return header()->checksum == compute_checksum();
+}
+
+void MappedFile::close() {
+    // Dirty MAP_SHARED pages reach the file even without msync(), flush() only makes it synchronous.
+    if (m_base) munmap(m_base, m_mapped);
+    if (m_fd >= 0) ::close(m_fd);
+    m_base = nullptr;
+    m_fd = -1;
+    m_mapped = 0;
+    m_capacity = 0;
+}
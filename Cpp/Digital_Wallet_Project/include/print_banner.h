@@ -24,43 +24,46 @@ inline int getTerminalWidth() {
 }
 #endif
 
+/// Width for a banner on out: the terminal's for std::cout, 80 columns for anything else
+inline int bannerWidth(std::ostream &out) { return &out == &std::cout ? getTerminalWidth() : 80; }
+
 /// Print a single-line banner (centered message, full width)
-inline void printBanner(const std::string &message, char fill = '=') {
-    int width = getTerminalWidth();
+inline void printBanner(const std::string &message, char fill = '=', std::ostream &out = std::cout) {
+    int width = bannerWidth(out);
     if (width <= 0) width = 80;  // fallback
 
     // Top border
-    std::cout << "<" << std::string(width - 2, fill) << ">\n";
+    out << "<" << std::string(width - 2, fill) << ">\n";
 
     // Message line (centered)
     int padding = (width - 2 - static_cast<int>(message.size()) - 2) / 2;
     if (padding < 0) padding = 0;
 
-    std::cout << "<" << std::string(padding, fill) << " " << message << " "
+    out << "<" << std::string(padding, fill) << " " << message << " "
               << std::string(width - 2 - padding - static_cast<int>(message.size()) - 2, fill) << ">\n";
 
     // Bottom border
-    std::cout << "<" << std::string(width - 2, fill) << ">\n";
+    out << "<" << std::string(width - 2, fill) << ">\n";
 }
 
 /// Print a multi-line banner (each message on its own line)
-inline void printBanner(const std::vector<std::string> &messages, char fill = '=') {
-    int width = getTerminalWidth();
+inline void printBanner(const std::vector<std::string> &messages, char fill = '=', std::ostream &out = std::cout) {
+    int width = bannerWidth(out);
     if (width <= 0) width = 80;  // fallback
 
     // Top border
-    std::cout << "<" << std::string(width - 2, fill) << ">\n";
+    out << "<" << std::string(width - 2, fill) << ">\n";
 
     for (const auto &message : messages) {
         int padding = (width - 2 - static_cast<int>(message.size()) - 2) / 2;
         if (padding < 0) padding = 0;
 
-        std::cout << "<" << std::string(padding, fill) << " " << message << " "
+        out << "<" << std::string(padding, fill) << " " << message << " "
                   << std::string(width - 2 - padding - static_cast<int>(message.size()) - 2, fill) << ">\n";
     }
 
     // Bottom border
-    std::cout << "<" << std::string(width - 2, fill) << ">\n";
+    out << "<" << std::string(width - 2, fill) << ">\n";
 }
 
 #endif  // BANNER_PRINTER_H
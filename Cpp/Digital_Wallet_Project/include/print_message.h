@@ -7,7 +7,8 @@
 
 enum class MsgType { INFO, WARNING, ERROR, SUCCESS };
 
-inline void printMessage(const std::string& text, MsgType type = MsgType::INFO) {
+// out defaults to the terminal, wallet sessions pass their own stream.
+inline void printMessage(const std::string& text, MsgType type = MsgType::INFO, std::ostream& out = std::cout) {
     std::string prefix;
     switch (type) {
         case MsgType::INFO:
@@ -28,12 +29,13 @@ inline void printMessage(const std::string& text, MsgType type = MsgType::INFO)
     int width = 70;
     std::string line(width, '-');
 
-    std::cout << line << "\n";
-    std::cout << prefix << text << "\n";
-    std::cout << line << "\n";
+    out << line << "\n";
+    out << prefix << text << "\n";
+    out << line << "\n";
 }
 
-inline void printMessages(const std::vector<std::string>& texts, MsgType type = MsgType::INFO) {
+inline void printMessages(const std::vector<std::string>& texts, MsgType type = MsgType::INFO,
+                          std::ostream& out = std::cout) {
     std::string prefix;
     switch (type) {
         case MsgType::INFO:
@@ -53,11 +55,11 @@ inline void printMessages(const std::vector<std::string>& texts, MsgType type =
     int width = 70;
     std::string line(width, '-');
 
-    std::cout << line << "\n";
+    out << line << "\n";
     for (auto& text : texts) {
-        std::cout << prefix << text << "\n";
+        out << prefix << text << "\n";
     }
-    std::cout << line << "\n";
+    out << line << "\n";
 }
 
 #endif  // PRINT_MESSAGE_H
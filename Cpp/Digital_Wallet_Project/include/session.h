@@ -0,0 +1,132 @@
+#pragma once
+// Coroutine sessions: the welcome / login / sign-up / user / pay flows written as coroutines
+// that co_await their input, so one thread can interleave any number of sessions. Input is pushed
+// in with SessionEngine::feed() (the terminal, a script, a socket), output is collected per session.
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "menu.h"
+#include "users_list.h"
+
+// Task<T>: a lazily started coroutine. Awaiting it runs it, and when it finishes it resumes
+// its awaiter directly (symmetric transfer), so nested flows do not grow the stack.
+template <typename T>
+class Task {
+   public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept {
+            struct Resume {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                    auto next = h.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+            return Resume{};
+        }
+        void return_value(T v) { value = std::move(v); }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle) handle.destroy();
+    }
+
+    // Top level only: run until the first co_await that has to wait.
+    void start() { handle.resume(); }
+    bool done() const { return !handle || handle.done(); }
+    T result() {
+        if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+        return std::move(*handle.promise().value);
+    }
+
+    // co_await task: start it and come back here when it co_returns.
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle.promise().continuation = awaiter;
+        return handle;
+    }
+    T await_resume() { return result(); }
+
+   private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+// One wallet session: its own menu state, pending input words and collected output.
+struct Session {
+    int id = 0;
+    MenuState state;
+    std::deque<std::string> input;  // words, like std::cin >> word
+    std::ostringstream out;
+    std::coroutine_handle<> waiting;  // innermost flow blocked on input
+    Task<bool> flow;
+
+    // co_await session.word(): the next input word, suspending the session until one is fed.
+    auto word() {
+        struct Awaiter {
+            Session& s;
+            bool await_ready() const noexcept { return !s.input.empty(); }
+            void await_suspend(std::coroutine_handle<> h) noexcept { s.waiting = h; }
+            std::string await_resume() {
+                std::string w = std::move(s.input.front());
+                s.input.pop_front();
+                return w;
+            }
+        };
+        return Awaiter{*this};
+    }
+};
+
+class SessionEngine {
+    UsersList& users;
+    std::vector<std::unique_ptr<Session>> sessions;  // indexed by id, nullptr once closed
+    std::vector<int> free_ids;
+    size_t live = 0;
+
+   public:
+    explicit SessionEngine(UsersList& u_list);
+    SessionEngine(const SessionEngine&) = delete;
+    SessionEngine& operator=(const SessionEngine&) = delete;
+
+    // New session, run up to its first prompt. Returns its id.
+    int open();
+    // Hand a line of input to a session and run it until it needs more.
+    // Returns false once the session has quit (its output is still there until close()).
+    bool feed(int id, const std::string& line);
+    // Output produced since the last call.
+    std::string take_output(int id);
+    void close(int id);
+    size_t active() const { return live; }
+};
+
+// Serve one session per connection on a Unix stream socket, all from the calling thread.
+int serve_sessions(const std::string& path, UsersList& u_list);
+// Run count scripted sessions interleaved on one thread, report throughput and memory per session.
+int bench_sessions(int count);
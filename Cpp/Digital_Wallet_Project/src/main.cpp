@@ -1,18 +1,30 @@
-#include <unistd.h>
-
+#include <cstdlib>
 #include <iostream>
 #include <string>
 
 // User defined Header files
-#include "app.h"
-#include "menu.h"
-#include "print_banner.h"
-#include "print_message.h"
+#include "session.h"
 #include "user.h"
 #include "users_list.h"
-// #include "utilites.h"
 
-int main() {
+static int usage(const char* prog) {
+    std::cout << "usage: " << prog << " [--serve PATH | --bench-sessions N]\n";
+    return 1;
+}
+
+// ./main                        interactive wallet on the terminal
+// ./main --serve PATH           one wallet session per connection on a Unix socket
+// ./main --bench-sessions N     N scripted sessions interleaved on one thread
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (!mode.empty() && (argc != 3 || (mode != "--serve" && mode != "--bench-sessions"))) return usage(argv[0]);
+    if (mode == "--bench-sessions") {
+        char* end = nullptr;
+        long count = strtol(argv[2], &end, 10);
+        if (end == argv[2] || *end != '\0' || count < 1 || count > 10000000) return usage(argv[0]);
+        return bench_sessions(static_cast<int>(count));
+    }
+
     UsersList u_list(20);
 
     // Create a test user
@@ -23,12 +35,19 @@ int main() {
 
     u_list.add_user(u1);
 
-    // Shared menu state
-    MenuState state;
-
-    Application app(state, &u_list);
-
-    app.app_run();
+    if (mode == "--serve") return serve_sessions(argv[2], u_list);
+
+    // The terminal is one more session of the engine, fed a line at a time.
+    SessionEngine engine(u_list);
+    int id = engine.open();
+    std::cout << engine.take_output(id) << std::flush;
+    bool running = true;
+    std::string line;
+    while (running && std::getline(std::cin, line)) {
+        running = engine.feed(id, line);
+        std::cout << engine.take_output(id) << std::flush;
+    }
+    engine.close(id);
 
     return 0;
 }
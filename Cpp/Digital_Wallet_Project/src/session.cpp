@@ -0,0 +1,232 @@
+#include "session.h"
+
+#include <cstdlib>
+
+#include "print_banner.h"
+#include "print_message.h"
+
+namespace {
+
+const char* clear_screen = "\033[2J\033[1;1H";
+
+double to_amount(const std::string& word) { return strtod(word.c_str(), nullptr); }
+
+// One flow per screen. Each one co_returns false when the session should end (Quit),
+// true to go back to the screen that started it.
+
+Task<bool> pay_bills_flow(Session& s) {
+    User& user = *s.state.curr_user;
+    while (true) {
+        s.out << clear_screen;
+        printMessage("Pay Your Pills Here ", MsgType::INFO, s.out);
+        s.out << "[1] Recharge Mobile \n";
+        s.out << "[2] Pay electricity pills \n";
+        s.out << "[3] Pay College Fees \n";
+        s.out << "[4] quit \n";
+        s.out << "Please Make a Selection: ";
+        std::string query = co_await s.word();
+
+        if (query == "1") {
+            s.out << "Enter Mobile Number: ";
+            std::string number = co_await s.word();
+            s.out << "Enter Recharge Amount: ";
+            double amount = to_amount(co_await s.word());
+            if (!user.withdraw(amount)) {
+                printMessage("ERROR::Insufficient Balance", MsgType::ERROR, s.out);
+                continue;
+            }
+            s.out << number << "Recharged with amount " << amount << "Succesfully\n";
+        } else if (query == "4") {
+            co_return true;
+        } else {
+            co_return false;  // anything else ends the session
+        }
+    }
+}
+
+Task<bool> user_menu_flow(Session& s) {
+    User& user = *s.state.curr_user;
+    while (true) {
+        s.out << "Please Make a Selection\n";
+        s.out << "[1] View balance\n";
+        s.out << "[2] Withdraw\n";
+        s.out << "[3] Deposit\n";
+        s.out << "[4] Pay Pills\n";
+        s.out << "[5] Logout\n";
+        std::string query = co_await s.word();
+
+        if (query == "1") {
+            printMessage("Your Balance: " + std::to_string(user.get_balance()), MsgType::INFO, s.out);
+        } else if (query == "2") {
+            s.out << "Enter a value to withdraw: ";
+            double value = to_amount(co_await s.word());
+            if (value <= 0) {
+                printMessage("Invalid Value", MsgType::ERROR, s.out);
+            } else if (!user.withdraw(value)) {
+                printMessage("ERROR::Insufficient Balance", MsgType::ERROR, s.out);
+            }
+        } else if (query == "3") {
+            s.out << "Enter a value to deposit: ";
+            double value = to_amount(co_await s.word());
+            if (value > 0) {
+                user.deposit(value);
+                printMessage("Deposited Successfully\nYour new balance: " + std::to_string(user.get_balance()),
+                             MsgType::INFO, s.out);
+            } else {
+                printMessage("Invalid Value", MsgType::ERROR, s.out);
+            }
+        } else if (query == "4") {
+            if (!co_await pay_bills_flow(s)) co_return false;
+        } else if (query == "5") {
+            printMessage("Logged Out", MsgType::INFO, s.out);
+            co_return true;
+        } else {
+            printMessage("Invalid selection", MsgType::WARNING, s.out);
+        }
+    }
+}
+
+Task<bool> login_flow(Session& s, UsersList& users) {
+    while (true) {
+        s.out << clear_screen;
+        printMessage("Login Page::Enter Login Credentials", MsgType::INFO, s.out);
+        User user;
+        s.out << "Please enter user name: ";
+        user.set_username(co_await s.word());
+        s.out << "Enter Password: ";
+        user.set_userpasswd(co_await s.word());
+
+        if (auto result = users.search_users(user)) {
+            s.state.curr_user = *result;
+            s.out << clear_screen;
+            printBanner("Welcome " + s.state.curr_user->get_username(), '=', s.out);
+            bool keep_going = co_await user_menu_flow(s);
+            s.state.curr_user.reset();
+            co_return keep_going;
+        }
+
+        printMessage("Invalid username or password.", MsgType::ERROR, s.out);
+        s.out << "[R]etry or [Q]uit? ";
+        std::string choice = co_await s.word();
+        if (!choice.empty() && (choice[0] == 'q' || choice[0] == 'Q')) {
+            printMessage("Login cancelled.", MsgType::WARNING, s.out);
+            co_return true;
+        }
+    }
+}
+
+Task<bool> sign_up_flow(Session& s, UsersList& users) {
+    while (true) {
+        s.out << clear_screen;
+        printMessage("Sign-Up Page::Enter Login Credentials", MsgType::INFO, s.out);
+        s.out << "Please enter user name: ";
+        std::string user_name = co_await s.word();
+        s.out << "Enter Password: ";
+        std::string user_passwd = co_await s.word();
+        s.out << "Confirm Password: ";
+        std::string user_confirm_passwd = co_await s.word();
+
+        if (user_passwd != user_confirm_passwd) {
+            printMessage("ERROR::Password Didn't Match", MsgType::ERROR, s.out);
+            continue;
+        }
+
+        s.out << "Enter Initial Balance: ";
+        double init_balance = to_amount(co_await s.word());
+
+        User new_user;
+        new_user.set_username(user_name);
+        new_user.set_userpasswd(user_passwd);
+        new_user.deposit(init_balance);
+        if (!users.add_user(new_user)) {
+            printMessage("ERROR::Users List Is Full", MsgType::ERROR, s.out);
+            co_return true;
+        }
+        printMessage("User: " + user_name + "Created Successfully", MsgType::INFO, s.out);
+        co_return co_await login_flow(s, users);
+    }
+}
+
+Task<bool> welcome_flow(Session& s, UsersList& users) {
+    while (true) {
+        s.out << clear_screen;
+        printBanner("Welcome To Smart Wallet", '=', s.out);
+        printMessage("Login Page", MsgType::INFO, s.out);
+        s.out << "Please Make a Selection: \n";
+        s.out << "(S) Sign Up\n";
+        s.out << "(L) Login\n";
+        s.out << "(Q) Quit\n";
+        s.out << "==> ";
+        std::string query = co_await s.word();
+
+        bool keep_going = true;
+        if (query == "L" || query == "l") {
+            keep_going = co_await login_flow(s, users);
+        } else if (query == "S" || query == "s") {
+            keep_going = co_await sign_up_flow(s, users);
+        } else if (query == "Q" || query == "q") {
+            printMessage("Goodbye!", MsgType::INFO, s.out);
+            co_return false;
+        } else {
+            // A typo only costs a remote session the prompt, not the whole session.
+            printMessage("Invalid selection. Please try again.", MsgType::WARNING, s.out);
+        }
+        if (!keep_going) co_return false;
+    }
+}
+
+}  // namespace
+
+SessionEngine::SessionEngine(UsersList& u_list) : users(u_list) {}
+
+int SessionEngine::open() {
+    int id;
+    if (!free_ids.empty()) {
+        id = free_ids.back();
+        free_ids.pop_back();
+    } else {
+        id = static_cast<int>(sessions.size());
+        sessions.emplace_back();
+    }
+    sessions[id] = std::make_unique<Session>();
+    Session& s = *sessions[id];
+    s.id = id;
+    s.flow = welcome_flow(s, users);
+    live++;
+    s.flow.start();
+    return id;
+}
+
+bool SessionEngine::feed(int id, const std::string& line) {
+    if (id < 0 || id >= static_cast<int>(sessions.size()) || !sessions[id]) return false;
+    Session& s = *sessions[id];
+    if (s.flow.done()) return false;
+
+    size_t pos = 0;
+    while ((pos = line.find_first_not_of(" \t\r\n", pos)) != std::string::npos) {
+        size_t end = line.find_first_of(" \t\r\n", pos);
+        if (end == std::string::npos) end = line.size();
+        s.input.emplace_back(line, pos, end - pos);
+        pos = end;
+    }
+    if (s.waiting && !s.input.empty()) std::exchange(s.waiting, nullptr).resume();
+
+    if (!s.flow.done()) return true;
+    s.flow.result();  // rethrows whatever ended the flow early
+    return false;
+}
+
+std::string SessionEngine::take_output(int id) {
+    if (id < 0 || id >= static_cast<int>(sessions.size()) || !sessions[id]) return "";
+    std::ostringstream& out = sessions[id]->out;
+    std::string text = out.str();
+    out.str("");
+    return text;
+}
+
+void SessionEngine::close(int id) {
+    if (id < 0 || id >= static_cast<int>(sessions.size()) || !sessions[id]) return;
+    sessions[id].reset();
+    free_ids.push_back(id);
+    live--;
+}
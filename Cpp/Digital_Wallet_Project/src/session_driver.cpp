@@ -0,0 +1,157 @@
+#include <fcntl.h>
+#include <malloc.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "session.h"
+
+namespace {
+
+// One client of serve_sessions(): its session and what is still to be read / written.
+struct Connection {
+    int session;
+    std::string in;
+    std::string out;
+};
+
+// Send as much of conn.out as the socket takes now, the rest waits for POLLOUT.
+void flush_connection(int fd, Connection& conn) {
+    while (!conn.out.empty()) {
+        ssize_t n = send(fd, conn.out.data(), conn.out.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n <= 0) return;
+        conn.out.erase(0, n);
+    }
+}
+
+}  // namespace
+
+int serve_sessions(const std::string& path, UsersList& u_list) {
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        printMessage("Socket path too long", MsgType::ERROR);
+        return 1;
+    }
+    strcpy(addr.sun_path, path.c_str());
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    unlink(path.c_str());
+    if (listener < 0 || bind(listener, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listener, 128) < 0) {
+        perror(path.c_str());
+        return 1;
+    }
+    printMessage("Serving wallet sessions on " + path, MsgType::INFO);
+
+    SessionEngine engine(u_list);
+    std::map<int, Connection> connections;  // by socket fd
+    std::vector<struct pollfd> fds;
+    while (true) {
+        fds.assign(1, {listener, POLLIN, 0});
+        for (auto& [fd, conn] : connections) {
+            fds.push_back({fd, static_cast<short>(conn.out.empty() ? POLLIN : POLLIN | POLLOUT), 0});
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            return 1;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd;
+            while ((fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK)) >= 0) {
+                Connection& conn = connections[fd];
+                conn.session = engine.open();
+                conn.out = engine.take_output(conn.session);
+                flush_connection(fd, conn);
+            }
+        }
+
+        for (size_t i = 1; i < fds.size(); i++) {
+            if (fds[i].revents == 0) continue;
+            int fd = fds[i].fd;
+            Connection& conn = connections[fd];
+            bool alive = true;
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                char buff[4096];
+                ssize_t n = recv(fd, buff, sizeof(buff), MSG_DONTWAIT);
+                if (n > 0) {
+                    conn.in.append(buff, n);
+                } else if (n == 0 || errno != EAGAIN) {
+                    alive = false;
+                }
+            }
+            // Whole lines only, like a terminal in canonical mode.
+            size_t newline;
+            while (alive && (newline = conn.in.find('\n')) != std::string::npos) {
+                alive = engine.feed(conn.session, conn.in.substr(0, newline));
+                conn.in.erase(0, newline + 1);
+            }
+            conn.out += engine.take_output(conn.session);
+            flush_connection(fd, conn);
+            if (!alive) {
+                engine.close(conn.session);
+                connections.erase(fd);
+                close(fd);
+            }
+        }
+    }
+}
+
+int bench_sessions(int count) {
+    // Users are found by a linear search, keep the list small enough not to dominate.
+    const int n_users = 1000;
+    UsersList users(n_users);
+    for (int i = 0; i < n_users; i++) {
+        User u;
+        u.set_username("user" + std::to_string(i));
+        u.set_userpasswd("pw" + std::to_string(i));
+        u.deposit(1000);
+        users.add_user(u);
+    }
+
+    // Login, balance, withdraw, deposit, a mobile recharge, logout, quit.
+    const std::vector<std::string> script = {"L", "", "", "1", "2", "20", "3", "50", "4", "1", "0100", "10", "4", "5", "Q"};
+
+    SessionEngine engine(users);
+    std::vector<int> ids(count);
+    size_t heap_before = mallinfo2().uordblks;
+    for (int i = 0; i < count; i++) {
+        ids[i] = engine.open();
+        engine.take_output(ids[i]);
+    }
+    size_t heap_open = mallinfo2().uordblks;
+
+    // One word per session per round, so all sessions are in flight at once.
+    auto start = std::chrono::steady_clock::now();
+    size_t output_bytes = 0;
+    int finished = 0;
+    for (size_t step = 0; step < script.size(); step++) {
+        for (int i = 0; i < count; i++) {
+            std::string word = script[step];
+            if (step == 1) word = "user" + std::to_string(i % n_users);
+            if (step == 2) word = "pw" + std::to_string(i % n_users);
+            if (!engine.feed(ids[i], word)) finished++;
+            output_bytes += engine.take_output(ids[i]).size();
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    for (int id : ids) engine.close(id);
+
+    double words = static_cast<double>(count) * script.size();
+    printf("%d sessions on one thread, %d finished, %.3f s\n", count, finished, elapsed.count());
+    printf("  %.0f inputs/s, %.0f sessions/s, %.1f MB of output\n", words / elapsed.count(), count / elapsed.count(),
+           output_bytes / 1e6);
+    printf("  %.0f bytes of heap per waiting session\n", static_cast<double>(heap_open - heap_before) / count);
+    return finished == count ? 0 : 1;
+}
@@ -16,10 +16,8 @@ bool User::check_credentials(const User& other) const { return username == other
 
 bool User::operator==(const User& other) const { return username == other.username && password == other.password; }
 
-void User::withdraw(double amount) {
-    if (amount > balance) {
-        printMessage("ERROR::Insufficient Balance", MsgType::ERROR);
-        return;
-    }
+bool User::withdraw(double amount) {
+    if (amount > balance) return false;
     balance -= amount;
+    return true;
 }
\ No newline at end of file
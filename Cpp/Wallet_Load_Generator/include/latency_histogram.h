@@ -0,0 +1,50 @@
+/*
+// LatencyHistogram: HDR-style log-linear histogram of latencies in nanoseconds.
+// Values below 128 ns get a bucket each, above that every power of two is split into 64
+// buckets, so any recorded value is known to within 1/64 (~1.6%) from 1 ns up to 2^63 ns.
+// Recording is a couple of shifts and one increment; each thread fills its own histogram
+// and they are merged at the end.
+*/
+#pragma once  // Header Protection.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class LatencyHistogram {
+   public:
+    LatencyHistogram();
+
+    void record(uint64_t ns) {
+        counts[bucket_of(ns)]++;
+        total++;
+        if (ns > max_ns) max_ns = ns;
+        if (ns < min_ns) min_ns = ns;
+        sum_ns += ns;
+    }
+    void merge(const LatencyHistogram& other);
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? min_ns : 0; }
+    uint64_t max() const { return max_ns; }
+    double mean() const { return total ? static_cast<double>(sum_ns) / total : 0.0; }
+    // Highest value equivalent to the q-quantile's bucket (q = 0.99 for p99), exact max for q >= 1.
+    uint64_t percentile(double q) const;
+
+   private:
+    static constexpr int kLinearBuckets = 128;  // 2 * kSubBuckets
+    static constexpr int kSubBuckets = 64;      // per power of two
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t min_ns = UINT64_MAX;
+    uint64_t max_ns = 0;
+    uint64_t sum_ns = 0;
+
+    static int bucket_of(uint64_t ns) {
+        if (ns < kLinearBuckets) return static_cast<int>(ns);
+        int shift = 63 - __builtin_clzll(ns) - 6;  // keep the top 7 bits: 64..127
+        return (shift + 1) * kSubBuckets + static_cast<int>((ns >> shift) - kSubBuckets);
+    }
+    static uint64_t bucket_high(int bucket);
+};
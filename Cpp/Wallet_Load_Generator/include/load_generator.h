@@ -0,0 +1,41 @@
+/*
+// Closed-loop load generator for the wallet engine (UsersList / User from Digital_Wallet_Project).
+// Every simulated user is a thread that logs in, then runs operations back to back, each picked
+// at random from a weighted mix, and times each one. Like a wallet session, a login searches the
+// shared UsersList and keeps its own copy of the User, which balance, deposit, withdraw and bill
+// payment then work on. Nothing writes the list during a run, so the threads read it without a lock.
+*/
+#pragma once  // Header Protection.
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "latency_histogram.h"
+#include "users_list.h"
+
+enum class WalletOp { Login, Balance, Deposit, Withdraw, PayBill };
+constexpr int kWalletOps = 5;
+const char* op_name(WalletOp op);
+
+struct LoadConfig {
+    int users = 8;             // concurrent simulated users (threads)
+    int accounts = 1000;       // accounts in the UsersList
+    double seconds = 5.0;      // run time
+    int think_us = 0;          // pause between one user's operations
+    std::array<int, kWalletOps> mix = {10, 40, 20, 20, 10};  // weights, in WalletOp order
+};
+
+struct LoadReport {
+    double seconds = 0;
+    std::array<LatencyHistogram, kWalletOps> per_op;
+    std::array<uint64_t, kWalletOps> failed = {};  // wrong password / insufficient balance
+    LatencyHistogram all;
+};
+
+// Accounts "user<i>" / "pw<i>", each with a starting balance.
+void seed_accounts(UsersList& accounts, int count);
+// "login=10,balance=40,..." into config.mix, false on an unknown name or a weight that is not
+// a number in 0..1000000.
+bool parse_mix(const std::string& text, LoadConfig& config);
+LoadReport run_load(const LoadConfig& config, const UsersList& accounts);
@@ -0,0 +1,36 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Buckets 0..127 are linear, then 64 per power of two up to shift 57 (values below 2^64).
+LatencyHistogram::LatencyHistogram() : counts(58 * kSubBuckets + kSubBuckets, 0) {}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t b = 0; b < counts.size(); b++) counts[b] += other.counts[b];
+    total += other.total;
+    sum_ns += other.sum_ns;
+    max_ns = std::max(max_ns, other.max_ns);
+    min_ns = std::min(min_ns, other.min_ns);
+}
+
+uint64_t LatencyHistogram::bucket_high(int bucket) {
+    if (bucket < kLinearBuckets) return bucket;
+    int shift = bucket / kSubBuckets - 1;
+    uint64_t low = static_cast<uint64_t>(bucket % kSubBuckets + kSubBuckets) << shift;
+    return low + (uint64_t(1) << shift) - 1;
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    if (total == 0) return 0;
+    if (q >= 1.0) return max_ns;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * total));
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < counts.size(); b++) {
+        seen += counts[b];
+        // A bucket's top can be above the largest value really recorded.
+        if (seen >= rank) return std::min(bucket_high(static_cast<int>(b)), max_ns);
+    }
+    return max_ns;
+}
@@ -0,0 +1,168 @@
+#include "load_generator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+const char* op_name(WalletOp op) {
+    switch (op) {
+        case WalletOp::Login:
+            return "login";
+        case WalletOp::Balance:
+            return "balance";
+        case WalletOp::Deposit:
+            return "deposit";
+        case WalletOp::Withdraw:
+            return "withdraw";
+        case WalletOp::PayBill:
+            return "paybill";
+    }
+    return "?";
+}
+
+void seed_accounts(UsersList& accounts, int count) {
+    for (int i = 0; i < count; i++) {
+        User u;
+        u.set_username("user" + std::to_string(i));
+        u.set_userpasswd("pw" + std::to_string(i));
+        u.deposit(1000);
+        accounts.add_user(u);
+    }
+}
+
+bool parse_mix(const std::string& text, LoadConfig& config) {
+    std::array<int, kWalletOps> mix = {};
+    std::stringstream items(text);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        std::string name = item.substr(0, eq);
+        const char* value = item.c_str() + eq + 1;
+        char* end = nullptr;
+        long weight = strtol(value, &end, 10);
+        // Capped so the sum over all operations still fits the int the users pick from.
+        if (end == value || *end != '\0' || weight < 0 || weight > 1000000) return false;
+        int op = 0;
+        while (op < kWalletOps && name != op_name(static_cast<WalletOp>(op))) op++;
+        if (op == kWalletOps) return false;
+        mix[op] = static_cast<int>(weight);
+    }
+    for (int w : mix) {
+        if (w > 0) {
+            config.mix = mix;
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+
+// xorshift64: cheap per-thread randomness, no shared state.
+struct Random {
+    uint64_t state;
+    uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+struct UserResult {
+    std::array<LatencyHistogram, kWalletOps> per_op;
+    std::array<uint64_t, kWalletOps> failed = {};
+};
+
+// One simulated user, closed loop: the next operation starts when the last one is done.
+void simulate_user(int index, const LoadConfig& config, const UsersList& accounts, const std::atomic<bool>& stop,
+                   UserResult& result) {
+    Random rng{0x9E3779B97F4A7C15ull * (index + 1)};
+    int weight_sum = 0;
+    for (int w : config.mix) weight_sum += w;
+    User session;
+    std::string receipt;
+    bool first = true;
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        // Everyone starts by logging in, then follows the mix.
+        WalletOp op = WalletOp::Login;
+        if (!first) {
+            int pick = static_cast<int>(rng.next() % weight_sum);
+            int i = 0;
+            while (pick >= config.mix[i]) pick -= config.mix[i++];
+            op = static_cast<WalletOp>(i);
+        }
+        first = false;
+        double amount = static_cast<double>(rng.next() % 200 + 1);
+
+        bool ok = true;
+        auto start = std::chrono::steady_clock::now();
+        switch (op) {
+            case WalletOp::Login: {
+                int account = static_cast<int>(rng.next() % config.accounts);
+                User credentials;
+                credentials.set_username("user" + std::to_string(account));
+                // One login in 50 mistypes the password.
+                credentials.set_userpasswd(rng.next() % 50 ? "pw" + std::to_string(account) : "wrong");
+                std::optional<User> found = accounts.search_users(credentials);
+                if (found) {
+                    session = *found;
+                } else {
+                    ok = false;
+                }
+                break;
+            }
+            case WalletOp::Balance:
+                receipt = "Your Balance: " + std::to_string(session.get_balance());
+                break;
+            case WalletOp::Deposit:
+                session.deposit(amount);
+                break;
+            case WalletOp::Withdraw:
+                ok = session.withdraw(amount);
+                break;
+            case WalletOp::PayBill:
+                ok = session.withdraw(amount);
+                if (ok) receipt = "01000000000 Recharged with amount " + std::to_string(amount);
+                break;
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+        int slot = static_cast<int>(op);
+        result.per_op[slot].record(static_cast<uint64_t>(ns.count()));
+        if (!ok) result.failed[slot]++;
+        if (config.think_us > 0) std::this_thread::sleep_for(std::chrono::microseconds(config.think_us));
+    }
+}
+
+}  // namespace
+
+LoadReport run_load(const LoadConfig& config, const UsersList& accounts) {
+    std::atomic<bool> stop{false};
+    std::vector<UserResult> results(config.users);
+    std::vector<std::thread> users;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < config.users; i++) {
+        users.emplace_back(simulate_user, i, std::cref(config), std::cref(accounts), std::cref(stop), std::ref(results[i]));
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(config.seconds));
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& t : users) t.join();
+
+    LoadReport report;
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const UserResult& r : results) {
+        for (int op = 0; op < kWalletOps; op++) {
+            report.per_op[op].merge(r.per_op[op]);
+            report.all.merge(r.per_op[op]);
+            report.failed[op] += r.failed[op];
+        }
+    }
+    return report;
+}
@@ -0,0 +1,70 @@
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// User defined Header files
+#include "latency_histogram.h"
+#include "load_generator.h"
+#include "users_list.h"
+
+// ./main [--users N] [--accounts N] [--seconds S] [--think-us US]
+//        [--mix login=10,balance=40,deposit=20,withdraw=20,paybill=10]
+static void print_row(const char* name, const LatencyHistogram& h, uint64_t failed, double seconds) {
+    printf("%-9s %10" PRIu64 " %12.0f %8" PRIu64 " %8" PRIu64 " %8" PRIu64 " %8" PRIu64 " %10" PRIu64 " %8" PRIu64 "\n",
+           name, h.count(), h.count() / seconds, h.percentile(0.50), h.percentile(0.99), h.percentile(0.999), h.max(),
+           failed, static_cast<uint64_t>(h.mean()));
+}
+
+int main(int argc, char* argv[]) {
+    LoadConfig config;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--users" && has_value) {
+            config.users = atoi(argv[++i]);
+        } else if (arg == "--accounts" && has_value) {
+            config.accounts = atoi(argv[++i]);
+        } else if (arg == "--seconds" && has_value) {
+            config.seconds = atof(argv[++i]);
+        } else if (arg == "--think-us" && has_value) {
+            config.think_us = atoi(argv[++i]);
+        } else if (arg == "--mix" && has_value) {
+            if (!parse_mix(argv[++i], config)) {
+                std::cout << "ERROR: bad --mix, expected e.g. login=10,balance=40,deposit=20,withdraw=20,paybill=10\n";
+                return 1;
+            }
+        } else {
+            std::cout << "usage: " << argv[0]
+                      << " [--users N] [--accounts N] [--seconds S] [--think-us US] [--mix op=weight,...]\n";
+            return 1;
+        }
+    }
+    if (config.users < 1 || config.accounts < 1 || config.seconds <= 0) {
+        std::cout << "ERROR: --users, --accounts and --seconds must be positive\n";
+        return 1;
+    }
+
+    UsersList accounts(config.accounts);
+    seed_accounts(accounts, config.accounts);
+
+    printf("%d users, %d accounts, %.1f s, think %d us, mix", config.users, config.accounts, config.seconds,
+           config.think_us);
+    for (int op = 0; op < kWalletOps; op++) printf(" %s=%d", op_name(static_cast<WalletOp>(op)), config.mix[op]);
+    printf("\n\n");
+
+    LoadReport report = run_load(config, accounts);
+
+    printf("%-9s %10s %12s %8s %8s %8s %8s %10s %8s\n", "op", "count", "ops/s", "p50 ns", "p99 ns", "p999 ns",
+           "max ns", "failed", "mean ns");
+    uint64_t failed = 0;
+    for (int op = 0; op < kWalletOps; op++) {
+        if (report.per_op[op].count() == 0) continue;
+        print_row(op_name(static_cast<WalletOp>(op)), report.per_op[op], report.failed[op], report.seconds);
+        failed += report.failed[op];
+    }
+    print_row("all", report.all, failed, report.seconds);
+
+    return 0;
+}
@@ -1,30 +1,574 @@
+// Build: g++ -Wall -O2 -std=c++20 brightness.cpp -o brightness
+//
+// brightness [--root DIR] --list
+//     Show every backlight under /sys/class/backlight.
+// brightness [--root DIR] [--device NAME]... [--all] LEVEL
+//     Set the backlight once. LEVEL is a raw value or a percentage ("40%").
+// brightness [--root DIR] [--device NAME]... [--all] --daemon [--rate HZ] [--fade MS] [--socket PATH]
+//     Keep the sysfs files open and read levels from stdin, one per line, and from datagrams on
+//     the control socket. Requests are merged per frame (1/HZ s) and the last one wins, every new
+//     level is reached by a fade of MS milliseconds, stepped HZ times a second by a timerfd.
+// brightness --socket PATH [LEVEL]
+//     Send LEVEL (default "?", just ask) to the daemon and print its answer: the current level.
+//     LEVEL may also be relative ("+5%", "-1000"), repeated steps add up within a frame.
+// brightness --socket PATH --bench N
+//     Load test: fire N requests at the daemon and report the rate and the sysfs writes it did.
+// Without --device or --all the preferred device is used (firmware, then platform, then raw).
+// --root replaces /sys, so every mode can run against a fake tree.
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/magic.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
-#include <fstream>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 
-const char* max_brightness_pwd = "/sys/devices/pci0000:00/0000:00:02.0/drm/card1/card1-eDP-1/intel_backlight/max_brightness";
-const char* brightness_pwd = "/sys/devices/pci0000:00/0000:00:02.0/drm/card1/card1-eDP-1/intel_backlight/brightness";
+// One backlight with its sysfs files held open, so a change is a single pwrite().
+// max_brightness and type never change while the device exists, they are read once here.
+class Backlight {
+   public:
+    Backlight(const std::string& dir, std::string name) : name(std::move(name)) {
+        int max_fd = open((dir + "/max_brightness").c_str(), O_RDONLY | O_CLOEXEC);
+        if (max_fd < 0) {
+            perror((dir + "/max_brightness").c_str());
+            return;
+        }
+        max_brightness = read_int(max_fd);
+        close(max_fd);
+        type = read_word(dir + "/type");
 
-int max_brightness = 0;
+        fd = open((dir + "/brightness").c_str(), O_RDWR | O_CLOEXEC);
+        if (fd < 0) {
+            perror((dir + "/brightness").c_str());
+            return;
+        }
+        current = read_int(fd);
+        // sysfs takes the whole value from one write at offset 0, a plain file (fake tree) keeps
+        // the tail of a longer old value unless it is cut off.
+        struct statfs fs;
+        truncate_writes = fstatfs(fd, &fs) == 0 && fs.f_type != SYSFS_MAGIC;
+    }
+    ~Backlight() {
+        if (fd >= 0) close(fd);
+    }
+    // non-copyable (owns the fd), movable so devices can live in a vector
+    Backlight(const Backlight&) = delete;
+    Backlight& operator=(const Backlight&) = delete;
+    Backlight(Backlight&& other) noexcept
+        : name(std::move(other.name)),
+          type(std::move(other.type)),
+          fd(std::exchange(other.fd, -1)),
+          max_brightness(other.max_brightness),
+          current(other.current),
+          truncate_writes(other.truncate_writes),
+          writes(other.writes) {}
+    Backlight& operator=(Backlight&& other) noexcept {
+        if (this != &other) {
+            if (fd >= 0) close(fd);
+            name = std::move(other.name);
+            type = std::move(other.type);
+            fd = std::exchange(other.fd, -1);
+            max_brightness = other.max_brightness;
+            current = other.current;
+            truncate_writes = other.truncate_writes;
+            writes = other.writes;
+        }
+        return *this;
+    }
 
-int main(int argc, char* argv[]) {
-    std::ifstream file(max_brightness_pwd);
+    bool ok() const { return fd >= 0 && max_brightness > 0; }
+    const std::string& get_name() const { return name; }
+    const std::string& get_type() const { return type; }
+    int get_max() const { return max_brightness; }
+    int level() const { return current; }
+    uint64_t write_count() const { return writes; }
+
+    // "40%" or a raw value, false if it does not parse or is out of 0..max.
+    // "+5%" / "-1000" are relative to base and clamped to 0..max instead.
+    bool parse_level(const std::string& text, int base, int& out) const {
+        char* end = nullptr;
+        double value = strtod(text.c_str(), &end);
+        // strtod also takes "nan" and "inf", which no level can be.
+        if (end == text.c_str() || !std::isfinite(value)) return false;
+        if (*end == '%') {
+            value = std::round(value * max_brightness / 100.0);
+            end++;
+        }
+        if (*end != '\0') return false;
+        if (text[0] == '+' || text[0] == '-') {
+            // A huge percentage overflows to inf above, clamp would hide it.
+            if (!std::isfinite(value)) return false;
+            value = std::clamp(base + value, 0.0, static_cast<double>(max_brightness));
+        } else if (value < 0 || value > max_brightness) {
+            return false;
+        }
+        out = static_cast<int>(value);
+        return true;
+    }
+
+    bool set(int value) {
+        if (value == current) return true;
+        char buff[16];
+        int len = snprintf(buff, sizeof(buff), "%d\n", value);
+        if (pwrite(fd, buff, len, 0) != len) {
+            perror(name.c_str());
+            return false;
+        }
+        if (truncate_writes && ftruncate(fd, len) < 0) perror(name.c_str());
+        current = value;
+        writes++;
+        return true;
+    }
+
+   private:
+    std::string name;
+    std::string type;
+    int fd = -1;
+    int max_brightness = 0;
+    int current = 0;
+    bool truncate_writes = false;
+    uint64_t writes = 0;
 
-    file >> max_brightness;
+    static int read_int(int from) {
+        char buff[32];
+        ssize_t n = pread(from, buff, sizeof(buff) - 1, 0);
+        if (n <= 0) return 0;
+        buff[n] = '\0';
+        return atoi(buff);
+    }
 
-    file.close();
+    static std::string read_word(const std::string& path) {
+        int from = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (from < 0) return "unknown";
+        char buff[32];
+        ssize_t n = read(from, buff, sizeof(buff) - 1);
+        close(from);
+        if (n <= 0) return "unknown";
+        std::string word(buff, n);
+        word.erase(word.find_last_not_of(" \n") + 1);
+        return word;
+    }
+};
+
+// The kernel's advice: firmware interfaces know the panel best, raw ones the least.
+int type_rank(const std::string& type) {
+    if (type == "firmware") return 0;
+    if (type == "platform") return 1;
+    if (type == "raw") return 2;
+    return 3;
+}
+
+// Every device under <root>/class/backlight, the preferred one first.
+std::vector<Backlight> discover_backlights(const std::string& root) {
+    std::vector<Backlight> lights;
+    std::string class_dir = root + "/class/backlight";
+    DIR* dir = opendir(class_dir.c_str());
+    if (dir == nullptr) {
+        perror(class_dir.c_str());
+        return lights;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') continue;
+        Backlight light(class_dir + "/" + entry->d_name, entry->d_name);
+        if (light.ok()) lights.push_back(std::move(light));
+    }
+    closedir(dir);
+    std::sort(lights.begin(), lights.end(), [](const Backlight& a, const Backlight& b) {
+        int ra = type_rank(a.get_type()), rb = type_rank(b.get_type());
+        return ra != rb ? ra < rb : a.get_name() < b.get_name();
+    });
+    return lights;
+}
 
-    std::ofstream brightness(brightness_pwd);
-    if (argc > 1) {
-        if (std::stoi(argv[1]) < max_brightness && std::stoi(argv[1]) > 20000) {
-            brightness << argv[1];
+// Parse LEVEL for every device first, then write them back to back, so one bad value
+// leaves all devices untouched. targets holds the levels relative requests start from.
+bool set_levels(std::vector<Backlight*>& lights, const std::string& text, std::vector<int>& targets) {
+    std::vector<int> parsed(lights.size());
+    for (size_t i = 0; i < lights.size(); i++) {
+        if (!lights[i]->parse_level(text, targets[i], parsed[i])) {
+            std::cerr << "brightness: " << text << " out of range for " << lights[i]->get_name() << "\n";
+            return false;
         }
+    }
+    targets = std::move(parsed);
+    return true;
+}
+
+// Interval of a timer ticking rate_hz times a second. At 1 Hz that is a whole second, which
+// tv_nsec cannot hold (timerfd_settime() would fail with EINVAL).
+struct timespec tick_period(int rate_hz) {
+    long period_ns = 1000000000L / rate_hz;
+    return {period_ns / 1000000000L, period_ns % 1000000000L};
+}
+
+// Linear fade of every selected device from its current level to its target, one step per timer tick.
+class Fader {
+   public:
+    Fader(std::vector<Backlight*> lights, int rate_hz, int fade_ms)
+        : lights(std::move(lights)), rate_hz(rate_hz), from(this->lights.size()), target(this->lights.size()) {
+        steps = static_cast<int64_t>(fade_ms) * rate_hz / 1000;
+        if (steps < 1) steps = 1;
+        step = steps;  // idle until start()
+        timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    }
+    ~Fader() {
+        if (timer >= 0) close(timer);
+    }
+    Fader(const Fader&) = delete;
+    Fader& operator=(const Fader&) = delete;
+
+    int fd() const { return timer; }
+    bool active() const { return step < steps; }
+
+    // A new target during a fade starts a new fade from wherever the old one got to.
+    // false if the timer could not be armed, the fade is then dropped.
+    bool start(const std::vector<int>& targets) {
+        for (size_t i = 0; i < lights.size(); i++) {
+            from[i] = lights[i]->level();
+            target[i] = targets[i];
+        }
+        struct timespec period = tick_period(rate_hz);
+        struct itimerspec spec = {period, period};
+        if (timerfd_settime(timer, 0, &spec, nullptr) < 0) {
+            perror("timerfd_settime");
+            step = steps;
+            return false;
+        }
+        step = 0;
+        return true;
+    }
+
+    // Timer fired: ticks missed while we were busy are skipped, not replayed.
+    void tick() {
+        uint64_t expirations = 0;
+        if (read(timer, &expirations, sizeof(expirations)) != sizeof(expirations)) return;
+        step += static_cast<int64_t>(expirations);
+        if (step >= steps) {
+            step = steps;
+            struct itimerspec off = {};
+            timerfd_settime(timer, 0, &off, nullptr);
+        }
+        for (size_t i = 0; i < lights.size(); i++) {
+            lights[i]->set(from[i] + static_cast<int>((static_cast<int64_t>(target[i]) - from[i]) * step / steps));
+        }
+    }
+
+   private:
+    std::vector<Backlight*> lights;
+    int rate_hz;
+    int timer;
+    std::vector<int> from;
+    std::vector<int> target;
+    int64_t step = 0;
+    int64_t steps = 1;
+};
+
+// Datagram socket at path, bound for the daemon or connected for a client. -1 on error.
+int control_socket(const std::string& path, bool server) {
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "brightness: socket path too long\n";
+        return -1;
+    }
+    strcpy(addr.sun_path, path.c_str());
+    int sock = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        perror("socket");
+        return -1;
+    }
+    if (server) {
+        // A socket left over from a previous daemon is replaced, anything else at path is not ours:
+        // the daemon usually runs as root, a mistyped --socket must not delete a file.
+        struct stat st;
+        if (lstat(path.c_str(), &st) == 0) {
+            if (!S_ISSOCK(st.st_mode)) {
+                std::cerr << "brightness: " << path << " exists and is not a socket\n";
+                close(sock);
+                return -1;
+            }
+            unlink(path.c_str());
+        }
+        if (bind(sock, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0) return sock;
     } else {
-        std::cout << "Please Enter Brightness\n";
+        // Autobind an abstract address, so the daemon has somewhere to send the answer.
+        struct sockaddr_un self = {};
+        self.sun_family = AF_UNIX;
+        if (bind(sock, reinterpret_cast<struct sockaddr*>(&self), sizeof(sa_family_t)) == 0 &&
+            connect(sock, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0) {
+            return sock;
+        }
     }
+    perror(path.c_str());
+    close(sock);
+    return -1;
+}
 
-    brightness.close();
+int run_daemon(std::vector<Backlight*>& lights, int rate_hz, int fade_ms, const std::string& socket_path) {
+    Fader fader(lights, rate_hz, fade_ms);
+    // One-shot timer closing the frame in which requests are merged.
+    int frame = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fader.fd() < 0 || frame < 0) {
+        perror("timerfd_create");
+        return 1;
+    }
+    int sock = -1;
+    if (!socket_path.empty() && (sock = control_socket(socket_path, true)) < 0) return 1;
+
+    // goal is the newest accepted target, applied when the frame closes.
+    std::vector<int> goal;
+    for (Backlight* light : lights) goal.push_back(light->level());
+    bool frame_open = false;
+    bool frame_failed = false;  // the frame timer could not be armed, stop serving
+    uint64_t requests = 0;
+    auto request = [&](const std::string& text) {
+        requests++;
+        if (!set_levels(lights, text, goal)) return false;
+        if (!frame_open) {
+            struct itimerspec spec = {{0, 0}, tick_period(rate_hz)};
+            if (timerfd_settime(frame, 0, &spec, nullptr) < 0) {
+                perror("timerfd_settime");
+                frame_failed = true;
+            }
+            frame_open = true;
+        }
+        return true;
+    };
+
+    std::string pending;
+    bool input_open = true;
+    while (!frame_failed && (input_open || fader.active() || frame_open || sock >= 0)) {
+        struct pollfd fds[4] = {
+            {fader.fd(), POLLIN, 0}, {frame, POLLIN, 0}, {sock, POLLIN, 0}, {input_open ? STDIN_FILENO : -1, POLLIN, 0}};
+        if (poll(fds, 4, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            return 1;
+        }
+        if (fds[0].revents & POLLIN) fader.tick();
+        if (fds[1].revents & POLLIN) {
+            uint64_t expirations;
+            if (read(frame, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+                frame_open = false;
+                if (!fader.start(goal)) {
+                    close(frame);
+                    return 1;
+                }
+            }
+        }
+
+        // Drain every queued datagram, a burst of key repeats then costs one poll() round.
+        while (fds[2].revents & POLLIN) {
+            char buff[64];
+            struct sockaddr_un from;
+            socklen_t from_len = sizeof(from);
+            ssize_t n = recvfrom(sock, buff, sizeof(buff) - 1, MSG_DONTWAIT, reinterpret_cast<struct sockaddr*>(&from), &from_len);
+            if (n < 0) break;
+            buff[n] = '\0';
+            std::string text(buff, strcspn(buff, "\n"));
+            std::string answer;
+            if (text == "stats") {
+                uint64_t writes = 0;
+                for (Backlight* light : lights) writes += light->write_count();
+                answer = "requests " + std::to_string(requests) + " writes " + std::to_string(writes);
+            } else if (text != "?" && !text.empty() && !request(text)) {
+                answer = "ERROR: " + text + " out of range";
+            } else {
+                for (Backlight* light : lights) {
+                    if (!answer.empty()) answer += ' ';
+                    answer += std::to_string(light->level()) + "/" + std::to_string(light->get_max());
+                }
+            }
+            answer += '\n';
+            // A client that stopped reading loses its answer, it does not stall the daemon.
+            sendto(sock, answer.data(), answer.size(), MSG_DONTWAIT, reinterpret_cast<struct sockaddr*>(&from), from_len);
+        }
+
+        if (!input_open || fds[3].revents == 0) continue;
+        char buff[512];
+        ssize_t n = read(STDIN_FILENO, buff, sizeof(buff));
+        if (n <= 0) {
+            input_open = false;  // without a socket: finish the running fade, then exit
+            continue;
+        }
+        pending.append(buff, n);
+        size_t newline;
+        while ((newline = pending.find('\n')) != std::string::npos) {
+            std::string line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            if (!line.empty()) request(line);
+        }
+    }
+    close(frame);
+    return frame_failed ? 1 : 0;
+}
+
+// Client side: send one request, print the answer.
+int run_client(const std::string& socket_path, const char* value) {
+    int sock = control_socket(socket_path, false);
+    if (sock < 0) return 1;
+    std::string text = value != nullptr ? value : "?";
+    char answer[256];
+    ssize_t n = -1;
+    struct pollfd pfd = {sock, POLLIN, 0};
+    if (send(sock, text.data(), text.size(), 0) >= 0 && poll(&pfd, 1, 1000) == 1) {
+        n = recv(sock, answer, sizeof(answer), 0);
+    }
+    close(sock);
+    if (n <= 0) {
+        std::cerr << "brightness: no answer from " << socket_path << "\n";
+        return 1;
+    }
+    fwrite(answer, 1, n, stdout);
+    return strncmp(answer, "ERROR", 5) == 0 ? 1 : 0;
+}
+
+// Load test: keep up to 64 requests in flight until count have been answered, then compare the
+// request count with the sysfs writes the daemon did.
+int run_bench(const std::string& socket_path, int count) {
+    int sock = control_socket(socket_path, false);
+    if (sock < 0) return 1;
+    auto stats = [&](uint64_t& requests, uint64_t& writes) {
+        char answer[128];
+        struct pollfd pfd = {sock, POLLIN, 0};
+        if (send(sock, "stats", 5, 0) < 0 || poll(&pfd, 1, 1000) != 1) return false;
+        ssize_t n = recv(sock, answer, sizeof(answer) - 1, 0);
+        if (n <= 0) return false;
+        answer[n] = '\0';
+        return sscanf(answer, "requests %" SCNu64 " writes %" SCNu64, &requests, &writes) == 2;
+    };
+    uint64_t requests_before, writes_before, requests_after, writes_after;
+    if (!stats(requests_before, writes_before)) {
+        std::cerr << "brightness: no answer from " << socket_path << "\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int sent = 0, answered = 0;
+    char answer[256];
+    while (answered < count) {
+        while (sent < count && sent - answered < 64) {
+            // Alternate steps up and down, like a held key going back and forth.
+            const char* text = (sent / 8) % 2 ? "-1%" : "+1%";
+            if (send(sock, text, strlen(text), 0) < 0) break;
+            sent++;
+        }
+        struct pollfd pfd = {sock, POLLIN, 0};
+        if (poll(&pfd, 1, 1000) != 1) {
+            std::cerr << "brightness: daemon stopped answering\n";
+            return 1;
+        }
+        while (recv(sock, answer, sizeof(answer), MSG_DONTWAIT) > 0) answered++;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (!stats(requests_after, writes_after)) return 1;
+    close(sock);
+
+    printf("%d requests in %.3f s (%.0f/s), daemon: %" PRIu64 " requests, %" PRIu64 " sysfs writes\n", count, elapsed.count(),
+           count / elapsed.count(), requests_after - requests_before, writes_after - writes_before);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::string root = "/sys";
+    std::vector<std::string> names;
+    bool all = false;
+    bool list = false;
+    bool daemon = false;
+    int rate_hz = 60;
+    int fade_ms = 250;
+    std::string socket_path;
+    int bench = 0;
+    const char* value = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--root" && i + 1 < argc) {
+            root = argv[++i];
+        } else if (arg == "--device" && i + 1 < argc) {
+            names.push_back(argv[++i]);
+        } else if (arg == "--all") {
+            all = true;
+        } else if (arg == "--list") {
+            list = true;
+        } else if (arg == "--daemon") {
+            daemon = true;
+        } else if (arg == "--rate" && i + 1 < argc) {
+            rate_hz = atoi(argv[++i]);
+        } else if (arg == "--fade" && i + 1 < argc) {
+            fade_ms = atoi(argv[++i]);
+        } else if (arg == "--socket" && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (arg == "--bench" && i + 1 < argc) {
+            bench = atoi(argv[++i]);
+        } else {
+            value = argv[i];
+        }
+    }
+    if (rate_hz < 1 || rate_hz > 1000 || fade_ms < 0) {
+        std::cerr << "brightness: --rate must be 1..1000 and --fade >= 0\n";
+        return 1;
+    }
+    // Clients never touch sysfs themselves.
+    if (!socket_path.empty() && !daemon) {
+        return bench > 0 ? run_bench(socket_path, bench) : run_client(socket_path, value);
+    }
+
+    std::vector<Backlight> found = discover_backlights(root);
+    if (found.empty()) {
+        std::cerr << "brightness: no backlight under " << root << "/class/backlight\n";
+        return 1;
+    }
+    if (list) {
+        for (const Backlight& light : found) {
+            printf("%-24s %-9s %d/%d (%ld%%)\n", light.get_name().c_str(), light.get_type().c_str(), light.level(),
+                   light.get_max(), std::lround(100.0 * light.level() / light.get_max()));
+        }
+        return 0;
+    }
+
+    std::vector<Backlight*> lights;
+    if (all) {
+        for (Backlight& light : found) lights.push_back(&light);
+    } else if (names.empty()) {
+        lights.push_back(&found[0]);
+    }
+    for (const std::string& name : names) {
+        auto it = std::find_if(found.begin(), found.end(), [&](const Backlight& l) { return l.get_name() == name; });
+        if (it == found.end()) {
+            std::cerr << "brightness: no backlight named " << name << "\n";
+            return 1;
+        }
+        if (!all) lights.push_back(&*it);
+    }
+
+    if (daemon) return run_daemon(lights, rate_hz, fade_ms, socket_path);
+
+    if (value == nullptr) {
+        std::cout << "Please Enter Brightness\n";
+        return 0;
+    }
+    std::vector<int> targets;
+    for (Backlight* light : lights) targets.push_back(light->level());
+    if (!set_levels(lights, value, targets)) return 1;
+    for (size_t i = 0; i < lights.size(); i++) lights[i]->set(targets[i]);
 
     return 0;
-}
\ No newline at end of file
+}
@@ -1,222 +1,385 @@
+// Build: gcc -Wall -O2 micro_shell.c -o micro -pthread
+#define _GNU_SOURCE  // pipe2()
+
+#include <dirent.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <libgen.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/sendfile.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 
 #define SIZE 256
-
-// New type for shell local variables represented as a key and value.
-typedef struct {
-    char *key;
-    char *value;
-} shellLocalVar;
+#define HISTORY_MERGE_LINES 4096  // Unsorted history lines scanned directly before a merge.
+#define PARALLEL_MAX_JOBS 4096    // Upper limit for `parallel -j`.
 
 // New type for command, arguments and stdin, out, err.
-
+// Every pointer is a view into the command line (or a variable's value), nothing is owned.
 typedef struct {
     char *command;
-    char *argArr[SIZE];
+    char **argArr;  // NULL-terminated, grown as needed and reused for the next line.
+    int argCount;
+    int argCap;
     char *stdoutFile;
     char *stdinFile;
     char *stderrFile;
+    int isAssignment;  // The command is a literal `name=value` word.
 } ParsedCommand;
 
+// Bump allocator for strings that live as long as the shell (local variables).
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t used;
+    size_t size;
+    char data[];
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock *head;  // Block currently being filled.
+} Arena;
+
+// Open-addressing string hash map (linear probing, power of two capacity).
+typedef struct {
+    char *key;  // NULL marks an empty slot.
+    char *value;
+    unsigned long hash;
+} StrMapEntry;
+
+typedef struct {
+    StrMapEntry *slots;
+    size_t capacity;
+    size_t count;
+    Arena *arena;  // If set, keys and values are carved from it and never freed one by one.
+} StrMap;
+
+// A background pipeline started with `&`.
+typedef struct {
+    int id;         // Job number shown as [id] and used as %id.
+    char *cmdline;  // Text of the line, for `jobs`.
+    pid_t *pids;    // One per stage, 0 once reaped (or if the stage never started).
+    int nStages;
+    int running;    // Stages not reaped yet.
+    int status;     // Exit status of the last stage.
+} Job;
+
+// Buffered reader on top of read(). Unlike stdio it never holds input that poll() can't see,
+// so the shell can wait on stdin and on the SIGCHLD signalfd at the same time.
+typedef struct {
+    int fd;        // stdin, the script file, or `parallel` arguments.
+    char *data;
+    size_t start;  // First byte not returned yet.
+    size_t end;    // End of the bytes read so far.
+    size_t cap;
+    int eof;
+    int reapJobs;  // Also reap background jobs while waiting (only for the shell's own input).
+} InputBuffer;
+
+// Command history: an append-only file, one command per line, mapped read-only.
+// Line offsets are indexed lazily and only for bytes not seen before. The sorted index is
+// kept in a sidecar file (path + ".idx"), so no shell has to sort the whole history.
+typedef struct {
+    int fd;             // Opened O_APPEND: concurrent shells each add whole lines.
+    char *map;
+    size_t mappedSize;
+    size_t indexedSize;  // Bytes already split into lines.
+    size_t *lines;       // Start offset of every line, oldest first.
+    size_t nLines;
+    size_t linesCap;
+    size_t *sorted;      // lines[0 .. nSorted) ordered by text, for prefix search. Newer lines
+    size_t nSorted;      // are scanned directly until enough pile up to be worth a merge.
+    size_t *newest;      // Max-offset tree over sorted[]: the newest line of any sorted range.
+    char *indexPath;     // Sidecar file holding sorted[], NULL: never saved or loaded.
+    int indexLoaded;     // The sidecar was read (or found missing) already.
+    size_t unsaved;      // Lines this shell appended since it last brought the index up to date.
+} History;
+
+// One `*.c`-style path component compiled once, then matched against every directory entry.
+typedef struct {
+    enum { GLOB_LITERAL, GLOB_ANY, GLOB_STAR, GLOB_CLASS } kind;
+    const char *text;       // GLOB_LITERAL: a run of plain bytes...
+    size_t len;             // ...and its length.
+    unsigned char set[32];  // GLOB_CLASS: bitmap of the accepted bytes.
+} GlobOp;
+
+typedef struct {
+    GlobOp *ops;
+    int nOps;
+    int matchHidden;  // Only a pattern starting with '.' matches dot files.
+} GlobPattern;
+
+// Growable list of matched paths (strings live in the line arena).
+typedef struct {
+    char **items;
+    size_t count;
+    size_t cap;
+} PathList;
+
+// Record layout of getdents64(2).
+struct linux_dirent64 {
+    ino64_t d_ino;
+    off64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
 extern char **environ;  // Global environment variables
 
 // Function declarations.
-void tokenize(shellLocalVar *localVars[], char buff[], ParsedCommand *cmd);
+int tokenize(StrMap *localVars, char buff[], ParsedCommand *cmd);
 void echo(char *args[]);
 void pwd(char currentDir[]);
-int addLocalVar(shellLocalVar *localVars[], shellLocalVar *newVar);
-int searchLocalVar(shellLocalVar *arr[], char *key);
 char *getEnvVarValue(const char *key);
-void freeParsedCommand(ParsedCommand *cmd);
+void buildEnvIndex(void);
+void historyOpen(History *h, const char *path);
+void historyAppend(History *h, const char *line);
+void historySync(History *h);
+long historyFind(History *h, const char *prefix, size_t prefixLen, size_t *first, size_t *last);
+char *historyExpand(History *h, const char *line);
+void historyBuiltIn(char *args[]);
+void addArg(ParsedCommand *cmd, char *arg);
+int globCompile(const char *pattern, GlobPattern *glob);
+int globMatch(const GlobPattern *glob, const char *name);
+void globExpand(char *pattern, ParsedCommand *cmd);
+void sortStrings(char **strings, size_t count);
 int isBuiltIn(char *cmd);
+int runsBuiltIn(ParsedCommand *cmd);
 void restoreOriginalFDs(int *originalFDs);
 void saveOriginalFDs(int *originalFDs);
+int applyRedirections(ParsedCommand *cmd);
+void runBuiltIn(ParsedCommand *cmd, char currentDir[]);
+int splitPipeline(char buff[], char *segments[], int maxSegments);
+int runPipeline(ParsedCommand *stages, int nStages, char currentDir[], char *jobText);
+pid_t spawnStage(ParsedCommand *cmd, const char *path, int inFd, int outFd);
+unsigned long hashString(const char *str);
+char *mapGet(StrMap *map, const char *key);
+int mapPut(StrMap *map, const char *key, const char *value);
+void mapDelete(StrMap *map, const char *key);
+void mapClear(StrMap *map);
+char *arenaAlloc(Arena *arena, size_t size);
+char *arenaStrdup(Arena *arena, const char *str);
+void arenaReset(Arena *arena);
+char *resolveCommand(const char *name);
+void hashBuiltIn(char *args[]);
+int parseLine(char line[], ParsedCommand **stages, int *stagesCap);
+void parseBenchmark(const char *corpusPath);
+void executeLine(ParsedCommand *stages, int nStages, char currentDir[], char *jobText);
+void timeCommand(ParsedCommand *stages, int nStages, char currentDir[], char *jobText);
+char *readLine(InputBuffer *in);
+int stripBackground(char line[]);
+void reapChildren(void);
+void notifyJobs(int report);
+int waitJob(Job *job);
+Job *findJob(const char *spec);
+void removeJob(Job *job);
+void jobsBuiltIn(char *args[]);
+int waitBuiltIn(char *args[]);
+int fgBuiltIn(char *args[]);
+int copyFd(int inFd, int outFd);
+int catBuiltIn(char *args[]);
+int cpBuiltIn(char *args[]);
+int parallelBuiltIn(char *args[]);
+
+int lastStatus = 0;     // Exit status of the last foreground pipeline (`$?`).
+StrMap commandCache;    // Command name -> absolute path, filled on first use (`hash`).
+Arena localArena;
+Arena lineArena;  // Scratch strings of the line being run (glob results), reset for every line.
+StrMap localVars = {NULL, 0, 0, &localArena};  // Shell local variables (`name=value`).
+StrMap envIndex;     // Name -> value copy of environ, kept in step by export/unset.
+int envIndexed = 0;  // envIndex is built on the first lookup.
+History shellHistory = {-1, NULL, 0, 0, NULL, 0, 0, NULL, 0, NULL, NULL, 0, 0};
+Job *jobs = NULL;  // Background jobs, oldest first.
+int nJobs = 0;
+int jobsCap = 0;
+int childFd = -1;      // signalfd() for SIGCHLD, which stays blocked in the shell.
+sigset_t shellSigMask;  // Signal mask the shell started with, restored in every child.
+int interactive = 1;    // 0 in script mode: no prompt, no job notices, cwd cached.
 
 // Main function.
 int main(int argc, char **argv) {
-    char buff[SIZE];
+    InputBuffer input = {STDIN_FILENO, NULL, 0, 0, 0, 0, 1};
     char currentDir[SIZE];
-    int status;
     // char *argArr[100];
-    shellLocalVar *localVars[100] = {NULL};
-    shellLocalVar currVar;
-    ParsedCommand cmd;
+    ParsedCommand *stages = NULL;  // Reused too, only reallocated for a longer pipeline.
+    int stagesCap = 0;
+
+    if (argc == 3 && strcmp(argv[1], "--bench-parse") == 0) {
+        parseBenchmark(argv[2]);
+        return 0;
+    }
+
+    // Script mode: `micro_shell script.sh`, or commands piped in.
+    if (argc == 2) {
+        if ((input.fd = open(argv[1], O_RDONLY | O_CLOEXEC)) < 0) {
+            perror(argv[1]);
+            exit(127);
+        }
+        interactive = 0;
+    } else if (!isatty(STDIN_FILENO)) {
+        interactive = 0;
+    }
+    if (!interactive) {
+        // Batch input: read it in big chunks, and only `cd` can change the directory.
+        input.cap = 1 << 20;
+        if ((input.data = (char *) malloc(input.cap)) == NULL) {
+            perror("Memory allocation faild");
+            exit(EXIT_FAILURE);
+        }
+        pwd(currentDir);
+    } else if (getEnvVarValue("HOME") != NULL) {
+        char *path = (char *) malloc(strlen(getEnvVarValue("HOME")) + sizeof("/.micro_history"));
+        sprintf(path, "%s/.micro_history", getEnvVarValue("HOME"));
+        historyOpen(&shellHistory, path);
+        free(path);
+    }
+
+    // Children are reaped from a signalfd instead of a handler, so SIGCHLD is blocked from here on.
+    sigset_t childSignal;
+    sigemptyset(&childSignal);
+    sigaddset(&childSignal, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &childSignal, &shellSigMask);
+    childFd = signalfd(-1, &childSignal, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (childFd < 0) {
+        perror("signalfd");
+        exit(EXIT_FAILURE);
+    }
 
     // Main loop.
     while (1) {
-        pwd(currentDir);
-        printf("\033[1;31m%s@Micro_shell:\033[0m \033[36m%s\033[0m $ ", getEnvVarValue("USER"), currentDir);
-        fgets(buff, SIZE, stdin);
-        //              buff[strlen(buff)-1] = 0; // replace the '\n' character with null terminator.
-
-        if (strlen(buff) == 0) continue;
-
-        tokenize(localVars, buff, &cmd);  // tokanize user input line.
-        // Check for Local Variable Assignment.
-        char *equalSign = strchr(cmd.command, '=');
-
-        if (isBuiltIn(cmd.command)) {
-            // Apply redirection for built-ins (in parent)
-            int originalFDs[3];
-            int redirected = 0;
-
-            if (cmd.stdinFile || cmd.stdoutFile || cmd.stderrFile) {
-                redirected = 1;
-                saveOriginalFDs(originalFDs);
-                // Handle stdout redirection
-                if (cmd.stdoutFile) {
-                    int fd = open(cmd.stdoutFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-                    if (fd < 0) {
-                        perror("open stdout");
-                        // exit (EXIT_FAILURE);
-                    }
-                    dup2(fd, STDOUT_FILENO);
-                    close(fd);
-                }
+        if (!interactive && nJobs > 0) {
+            notifyJobs(0);  // Scripts get no notices, but finished jobs still leave the table.
+        }
+        if (interactive) {
+            notifyJobs(1);
+            pwd(currentDir);
+            printf("\033[1;31m%s@Micro_shell:\033[0m \033[36m%s\033[0m $ ", getEnvVarValue("USER"), currentDir);
+            fflush(stdout);
+        }
+        char *line = readLine(&input);
+        if (line == NULL) {  // EOF (Ctrl+D or end of piped input).
+            if (interactive) printf("\n");
+            exit(lastStatus);
+        }
 
-                // Handle stderr redirection
-                if (cmd.stderrFile) {
-                    int fd = open(cmd.stderrFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-                    if (fd < 0) {
-                        perror("open stderr");
-                        // exit (EXIT_FAILURE);
-                    }
-                    dup2(fd, STDERR_FILENO);
-                    close(fd);
-                }
-            }
-            // Handle stdin redirection
-            if (cmd.stdinFile) {
-                int fd = open(cmd.stdinFile, O_RDONLY);
-                if (fd < 0) {
-                    perror("open stdin");
-                    // exit (EXIT_FAILURE);
+        // `!prefix` / `!!` recall, then the line (as run) goes to the history file.
+        char *expanded = NULL;
+        if (shellHistory.fd >= 0 && line[strspn(line, " \t")] != '\0') {
+            if (line[0] == '!') {
+                if ((expanded = historyExpand(&shellHistory, line)) == NULL) {
+                    lastStatus = 1;
+                    continue;
                 }
-                dup2(fd, STDIN_FILENO);
-                close(fd);
+                line = expanded;
+                printf("%s\n", line);
             }
+            historyAppend(&shellHistory, line);
+        }
 
-            // Built-in commands and new process creation (linux native commands).
-            if (strcmp(cmd.command, "echo") == 0) {
-                echo(cmd.argArr);
-            } else if (strcmp(cmd.command, "pwd") == 0) {
-                printf("%s\n", currentDir);
-            } else if (strcmp(cmd.command, "cd") == 0) {
-                // Note: chdir() function only accepts path starting with '/'.
-                if (chdir(cmd.argArr[1]) < 0) {
-                    perror("Invalid Path!!\n");
-                }
-            } else if (strcmp(cmd.command, "exit") == 0) {
-                exit(0);
-            } else if (strcmp(cmd.command, "export") == 0)  // Add a Global Variable.
-            {
-                char *equalSign = strchr(cmd.argArr[1], '=');
-                if (equalSign == NULL) {
-                    printf("ERROR: can't create empty variable\n");
-                    printf("usage: export varName=\"value\"\n");
-                } else {
-                    const char *value = equalSign + 1;
-                    int keyLen = equalSign - cmd.argArr[1];
-                    char *name = (char *) malloc(sizeof(char) * (keyLen) + 1);
-                    name = strncpy(name, cmd.argArr[1], keyLen);
-                    name[keyLen] = '\0';
-                    setenv(name, value, 1);
-                }
-            } else if (strcmp(cmd.command, "unset") == 0)  // Delete a Global Variable.
-            {
-                unsetenv(cmd.argArr[1]);
-            }
-            // Restore original file descriptors
-            if (redirected) {
-                restoreOriginalFDs(originalFDs);
-            }
-        } else if ((cmd.argArr[1] == NULL) && (equalSign != NULL))  // Assign a Local Variable.
-        {
-            // Local Variables
-            int i = 0;
-            int keyLen = equalSign - cmd.command;
-            currVar.key = (char *) malloc(sizeof(char) * (keyLen + 1));
-            strncpy(currVar.key, cmd.command, keyLen);
-            currVar.key[keyLen] = '\0';
-
-            int valueLen = strlen(equalSign + 1);
-            currVar.value = (char *) malloc(sizeof(char) * (valueLen + 1));
-            strcpy(currVar.value, equalSign + 1);
-
-            if (addLocalVar(localVars, &currVar) != 0) {
-                printf("Local Var Not Added!!\n");
-            }
+        // `cmd &` runs in the background, keep the text for `jobs` before parsing cuts it up.
+        char *jobText = stripBackground(line) ? strdup(line + strspn(line, " \t")) : NULL;
 
-        } else {
-            pid_t child_pid = fork();
-            if (child_pid == 0) {
-                // char *argv[] = { NULL };
-                // char *envp[] = { NULL };
-
-                // Handle I/O Redirection For Child Process.
-                // 1. Stdout File Redirection.
-                if (cmd.stdoutFile) {
-                    int fd = open(cmd.stdoutFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-                    if (fd < 0) {
-                        perror("open stdout");
-                        exit(EXIT_FAILURE);
-                    }
-                    dup2(fd, STDOUT_FILENO);
-                    close(fd);
-                }
-                // 2. Stderr File Redirection.
-                if (cmd.stderrFile) {
-                    int fd = open(cmd.stderrFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-                    if (fd < 0) {
-                        perror("open stderr");
-                        exit(EXIT_FAILURE);
-                    }
-                    dup2(fd, STDERR_FILENO);
-                    close(fd);
-                }
-                // 3. Stdin File Redirection.
-                if (cmd.stdinFile) {
-                    int fd = open(cmd.stdinFile, O_RDONLY);
-                    if (fd < 0) {
-                        perror("open stdin");
-                        exit(EXIT_FAILURE);
-                    }
-                    dup2(fd, STDIN_FILENO);
-                    close(fd);
-                }
+        // Split `cmd1 | cmd2 | ...` into stages, then tokenize every stage.
+        int nStages = parseLine(line, &stages, &stagesCap);
+        if (nStages < 0) {
+            lastStatus = 2;  // Syntax error, like sh.
+            free(jobText);
+            free(expanded);
+            continue;
+        }
+        executeLine(stages, nStages, currentDir, jobText);
+        free(expanded);
+    }
 
-                execvp(cmd.command, cmd.argArr);  // Supports program execution directly (check `man exec`).
+    return 0;
+}
 
-                printf("ERROR: %s Execution Faild!!\n", cmd.command);
-                exit(-1);
-            } else if (child_pid > 0) {
-                wait(&status);
-                // printf
-                ("PARENT: I'm %d, and my child returned with a status: %d\n", getpid(), WEXITSTATUS(status));
-            } else {
-                printf("ERROR: can't create process\n");
-                exit(-1);
-            }
+// Run one parsed line: a built-in in the shell itself, a local variable assignment, or a pipeline.
+// Takes ownership of jobText (set for a `&` line).
+void executeLine(ParsedCommand *stages, int nStages, char currentDir[], char *jobText) {
+    ParsedCommand *cmd = &stages[0];
+
+    if (cmd->command == NULL) {
+        // Empty line.
+    } else if (strcmp(cmd->command, "time") == 0) {
+        timeCommand(stages, nStages, currentDir, jobText);
+        jobText = NULL;
+    } else if (nStages == 1 && runsBuiltIn(cmd) && jobText == NULL) {
+        // Apply redirection for built-ins (in parent)
+        int originalFDs[3];
+        saveOriginalFDs(originalFDs);
+        lastStatus = 1;
+        if (applyRedirections(cmd) == 0) {
+            lastStatus = 0;  // Built-ins that can fail set it themselves.
+            runBuiltIn(cmd, currentDir);
+        }
+        // Restore original file descriptors
+        restoreOriginalFDs(originalFDs);
+    } else if (nStages == 1 && (cmd->argArr[1] == NULL) && cmd->isAssignment)  // Assign a Local Variable.
+    {
+        // Local Variables: split `name=value` in place, the map keeps its own copies.
+        char *equalSign = strchr(cmd->command, '=');
+        *equalSign = '\0';
+        if (mapPut(&localVars, cmd->command, equalSign + 1) != 0) {
+            printf("Local Var Not Added!!\n");
         }
-        freeParsedCommand(&cmd);
+    } else {
+        lastStatus = runPipeline(stages, nStages, currentDir, jobText);
+        jobText = NULL;  // Owned by the job table now.
     }
-    // Memory de-allocation.
-    int i = 0;
-    free(currVar.key);
-    free(currVar.value);
+    free(jobText);
+}
 
-    return 0;
+// `time cmd ...`: run the rest of the line (the whole pipeline) and report wall, user and sys time
+// on stderr. User/sys cover the reaped children plus the shell itself, for built-ins.
+void timeCommand(ParsedCommand *stages, int nStages, char currentDir[], char *jobText) {
+    ParsedCommand *cmd = &stages[0];
+    memmove(&cmd->argArr[0], &cmd->argArr[1], cmd->argCount * sizeof(char *));  // Drop `time`, keeps the NULL.
+    cmd->argCount--;
+    cmd->command = cmd->argArr[0];
+    cmd->isAssignment = 0;
+
+    struct timespec start, end;
+    struct rusage childrenBefore, childrenAfter, selfBefore, selfAfter;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    getrusage(RUSAGE_CHILDREN, &childrenBefore);
+    getrusage(RUSAGE_SELF, &selfBefore);
+
+    executeLine(stages, nStages, currentDir, jobText);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    getrusage(RUSAGE_CHILDREN, &childrenAfter);
+    getrusage(RUSAGE_SELF, &selfAfter);
+
+#define ELAPSED(after, before) \
+    ((after).tv_sec - (before).tv_sec + ((after).tv_usec - (before).tv_usec) / 1e6)
+    double real = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1e9;
+    double user = ELAPSED(childrenAfter.ru_utime, childrenBefore.ru_utime) + ELAPSED(selfAfter.ru_utime, selfBefore.ru_utime);
+    double sys = ELAPSED(childrenAfter.ru_stime, childrenBefore.ru_stime) + ELAPSED(selfAfter.ru_stime, selfBefore.ru_stime);
+#undef ELAPSED
+
+    fflush(stdout);
+    fprintf(stderr, "\nreal\t%dm%.3fs\nuser\t%dm%.3fs\nsys\t%dm%.3fs\n", (int) real / 60, real - 60 * ((int) real / 60),
+            (int) user / 60, user - 60 * ((int) user / 60), (int) sys / 60, sys - 60 * ((int) sys / 60));
 }
 
 // Helper Functions.
 
 // Save Original Default File Descriptors Helper Function.
 void saveOriginalFDs(int *originalFDs) {
+    fflush(stdout);  // Pending output belongs to the old stdout.
     originalFDs[0] = dup(STDIN_FILENO);
     originalFDs[1] = dup(STDOUT_FILENO);
     originalFDs[2] = dup(STDERR_FILENO);
@@ -232,215 +395,1843 @@ void restoreOriginalFDs(int *originalFDs) {
     close(originalFDs[2]);
 }
 
-// Check if command is built-in Helper Function.
-int isBuiltIn(char *cmd) {
-    return strcmp(cmd, "echo") == 0 || strcmp(cmd, "pwd") == 0 || strcmp(cmd, "cd") == 0 || strcmp(cmd, "exit") == 0 ||
-           strcmp(cmd, "export") == 0 || strcmp(cmd, "unset") == 0;
+// Apply `<`, `>` and `2>` redirections of a command to the current process.
+// Returns -1 (after printing the reason) if a file can't be opened.
+int applyRedirections(ParsedCommand *cmd) {
+    // 1. Stdout File Redirection.
+    if (cmd->stdoutFile) {
+        int fd = open(cmd->stdoutFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            perror("open stdout");
+            return -1;
+        }
+        dup2(fd, STDOUT_FILENO);
+        close(fd);
+    }
+    // 2. Stderr File Redirection.
+    if (cmd->stderrFile) {
+        int fd = open(cmd->stderrFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            perror("open stderr");
+            return -1;
+        }
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+    }
+    // 3. Stdin File Redirection.
+    if (cmd->stdinFile) {
+        int fd = open(cmd->stdinFile, O_RDONLY);
+        if (fd < 0) {
+            perror("open stdin");
+            return -1;
+        }
+        dup2(fd, STDIN_FILENO);
+        close(fd);
+    }
+    return 0;
 }
 
-// Free memory allocated for parsed command.
-void freeParsedCommand(ParsedCommand *cmd) {
-    if (cmd->command) free(cmd->command);
-    for (int i = 0; cmd->argArr[i]; i++) free(cmd->argArr[i]);
-    if (cmd->stdinFile) free(cmd->stdinFile);
-    if (cmd->stdoutFile) free(cmd->stdoutFile);
-    if (cmd->stderrFile) free(cmd->stderrFile);
-    memset(cmd, 0, sizeof(ParsedCommand));  // reset all pointers
+// Run a built-in command in the current process.
+void runBuiltIn(ParsedCommand *cmd, char currentDir[]) {
+    // Built-in commands and new process creation (linux native commands).
+    if (strcmp(cmd->command, "echo") == 0) {
+        echo(cmd->argArr);
+    } else if (strcmp(cmd->command, "pwd") == 0) {
+        printf("%s\n", currentDir);
+    } else if (strcmp(cmd->command, "cd") == 0) {
+        // Note: chdir() function only accepts path starting with '/'.
+        if (chdir(cmd->argArr[1]) < 0) {
+            perror("Invalid Path!!\n");
+        } else {
+            pwd(currentDir);  // The only place the directory changes, script mode relies on it.
+        }
+    } else if (strcmp(cmd->command, "exit") == 0) {
+        exit(0);
+    } else if (strcmp(cmd->command, "export") == 0)  // Add a Global Variable.
+    {
+        char *equalSign = cmd->argArr[1] ? strchr(cmd->argArr[1], '=') : NULL;
+        if (equalSign == NULL) {
+            printf("ERROR: can't create empty variable\n");
+            printf("usage: export varName=\"value\"\n");
+        } else {
+            const char *value = equalSign + 1;
+            int keyLen = equalSign - cmd->argArr[1];
+            char *name = (char *) malloc(sizeof(char) * (keyLen) + 1);
+            name = strncpy(name, cmd->argArr[1], keyLen);
+            name[keyLen] = '\0';
+            setenv(name, value, 1);  // environ is what children get.
+            if (envIndexed) mapPut(&envIndex, name, value);
+            if (strcmp(name, "PATH") == 0) mapClear(&commandCache);  // Cached locations may be stale.
+            free(name);
+        }
+    } else if (strcmp(cmd->command, "unset") == 0)  // Delete a Global Variable.
+    {
+        if (cmd->argArr[1]) {
+            unsetenv(cmd->argArr[1]);
+            if (envIndexed) mapDelete(&envIndex, cmd->argArr[1]);
+            if (strcmp(cmd->argArr[1], "PATH") == 0) mapClear(&commandCache);
+        }
+    } else if (strcmp(cmd->command, "hash") == 0) {
+        hashBuiltIn(cmd->argArr);
+    } else if (strcmp(cmd->command, "jobs") == 0) {
+        jobsBuiltIn(cmd->argArr);
+    } else if (strcmp(cmd->command, "wait") == 0) {
+        lastStatus = waitBuiltIn(cmd->argArr);
+    } else if (strcmp(cmd->command, "fg") == 0) {
+        lastStatus = fgBuiltIn(cmd->argArr);
+    } else if (strcmp(cmd->command, "cat") == 0) {
+        lastStatus = catBuiltIn(cmd->argArr);
+    } else if (strcmp(cmd->command, "cp") == 0) {
+        lastStatus = cpBuiltIn(cmd->argArr);
+    } else if (strcmp(cmd->command, "history") == 0) {
+        historyBuiltIn(cmd->argArr);
+    } else if (strcmp(cmd->command, "parallel") == 0) {
+        lastStatus = parallelBuiltIn(cmd->argArr);
+    }
+    fflush(stdout);
 }
 
-// Helper Functions for local Varibles manipulation
-// Add new local Variable Function Definition.
-
-int addLocalVar(shellLocalVar *localVars[], shellLocalVar *newVar) {
-    int i = 0;
-    int index = searchLocalVar(localVars, newVar->key);
-    if (index == -1) {
-        while (localVars[i] != NULL && i < 100) {
-            i++;
+// Split a command line on `|` in place, returns the number of stages or -1 for an empty stage.
+int splitPipeline(char buff[], char *segments[], int maxSegments) {
+    int count = 0;
+    char *start = buff;
+    while (1) {
+        char *bar = strchr(start, '|');
+        if (count == maxSegments) return -1;
+        segments[count++] = start;
+        if (bar == NULL) break;
+        *bar = '\0';
+        start = bar + 1;
+    }
+    if (count > 1) {
+        // Every stage of a real pipeline needs a command.
+        for (int i = 0; i < count; i++) {
+            if (segments[i][strspn(segments[i], " \t\n")] == '\0') return -1;
         }
-        if (i >= 100) {
-            return -1;
+    }
+    return count;
+}
+
+// Split a line into pipeline stages and tokenize each one in place.
+// `stages` is grown as needed and reused between lines. Returns the number of stages,
+// or -1 after printing a syntax error.
+int parseLine(char line[], ParsedCommand **stages, int *stagesCap) {
+    char *segments[SIZE];
+    int nStages = splitPipeline(line, segments, SIZE);
+    if (nStages < 0) {
+        printf("ERROR: syntax error near `|'\n");
+        return -1;
+    }
+    if (nStages > *stagesCap) {
+        ParsedCommand *grown = (ParsedCommand *) realloc(*stages, nStages * sizeof(ParsedCommand));
+        if (grown == NULL) {
+            perror("Memory allocation faild");
+            exit(EXIT_FAILURE);
         }
+        memset(grown + *stagesCap, 0, (nStages - *stagesCap) * sizeof(ParsedCommand));  // No argArr yet.
+        *stages = grown;
+        *stagesCap = nStages;
+    }
+    arenaReset(&lineArena);  // The previous line is done with its glob results.
+    for (int i = 0; i < nStages; i++) {
+        if (tokenize(&localVars, segments[i], &(*stages)[i]) < 0) return -1;  // tokanize user input line.
+    }
+    return nStages;
+}
 
-        if ((localVars[i] = (shellLocalVar *) malloc(sizeof(shellLocalVar))) == NULL) {
-            return -1;
+// Parse every line of a corpus file repeatedly and report the throughput (`micro_shell --bench-parse FILE`).
+void parseBenchmark(const char *corpusPath) {
+    FILE *corpus = fopen(corpusPath, "r");
+    if (corpus == NULL) {
+        perror(corpusPath);
+        exit(EXIT_FAILURE);
+    }
+    // Load the corpus once so the timing covers parsing only.
+    char *text = NULL;
+    size_t textLen = 0;
+    FILE *mem = open_memstream(&text, &textLen);
+    char chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), corpus)) > 0) fwrite(chunk, 1, n, mem);
+    fclose(mem);
+    fclose(corpus);
+
+    char *work = (char *) malloc(textLen + 1);
+    ParsedCommand *stages = NULL;
+    int stagesCap = 0;
+    long lines = 0, tokens = 0;
+    int passes = 0;
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do {
+        // Tokenizing is destructive, so every pass starts from a fresh copy.
+        memcpy(work, text, textLen + 1);
+        for (char *lineStart = work; *lineStart != '\0';) {
+            char *lineEnd = memchr(lineStart, '\n', work + textLen - lineStart);
+            char *next = lineEnd ? lineEnd + 1 : work + textLen;
+            if (lineEnd) *lineEnd = '\0';
+            int nStages = parseLine(lineStart, &stages, &stagesCap);
+            for (int i = 0; i < nStages; i++) {
+                for (char **arg = stages[i].argArr; *arg != NULL; arg++) tokens++;
+            }
+            lines++;
+            lineStart = next;
         }
+        passes++;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while (now.tv_sec - start.tv_sec < 2);
 
-        localVars[i]->key = strdup(newVar->key);
-        localVars[i]->value = strdup(newVar->value);
+    double seconds = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+    printf("parsed %ld lines (%ld tokens, %d passes) in %.3f s: %.0f lines/s, %.1f MB/s\n", lines, tokens, passes,
+           seconds, lines / seconds, (double) textLen * passes / seconds / 1e6);
+    free(work);
+    free(stages);
+    free(text);
+}
 
-        if (localVars[i]->key == NULL || localVars[i]->value == NULL) {
-            free(localVars[i]->key);
-            free(localVars[i]->value);
-            free(localVars[i]);
-            return -1;
+// Run `stage0 | stage1 | ... | stageN-1`: every stage is its own process, all running
+// concurrently, joined by pipes created with O_CLOEXEC so no child keeps a stray pipe end open.
+// Returns the exit status of the last stage. With jobText the pipeline becomes a background job
+// instead (the job table takes ownership of jobText) and 0 is returned straight away.
+int runPipeline(ParsedCommand *stages, int nStages, char currentDir[], char *jobText) {
+    pid_t *pids = (pid_t *) calloc(nStages, sizeof(pid_t));
+    int prevRead = -1;  // Read end of the pipe feeding the current stage.
+    int started = 0;
+    int status = 0;
+
+    fflush(stdout);  // Children must not inherit (and re-print) buffered output.
+    for (int i = 0; i < nStages; i++) {
+        int fds[2] = {-1, -1};
+        if (i < nStages - 1 && pipe2(fds, O_CLOEXEC) < 0) {
+            perror("pipe2");
+            break;
+        }
+        // Resolve in the parent so the cache outlives the child.
+        char *path = NULL;
+        if (stages[i].command && !runsBuiltIn(&stages[i])) {
+            path = resolveCommand(stages[i].command);
         }
 
-        if (i + 1 < 100) {
-            localVars[i + 1] = NULL;
+        pid_t child_pid;
+        if (path != NULL) {
+            // External command: posix_spawn() shares the parent's memory until exec (no page table copy).
+            child_pid = spawnStage(&stages[i], path, prevRead, fds[1]);
+            if (child_pid < 0) {
+                // Nothing was started, the stage just fails; the rest of the pipeline keeps running.
+                if (i == nStages - 1) status = -child_pid;
+                child_pid = 0;
+            }
+        } else if ((child_pid = fork()) == 0) {
+            // Built-ins, empty stages and unknown commands still need a real copy of the shell.
+            sigprocmask(SIG_SETMASK, &shellSigMask, NULL);
+            // dup2() clears O_CLOEXEC on the copy, the original pipe fds close on exec.
+            if (prevRead != -1) dup2(prevRead, STDIN_FILENO);
+            if (fds[1] != -1) dup2(fds[1], STDOUT_FILENO);
+            // Handle I/O Redirection For Child Process (files win over pipes).
+            if (applyRedirections(&stages[i]) < 0) exit(EXIT_FAILURE);
+
+            if (stages[i].command == NULL) exit(0);
+            if (runsBuiltIn(&stages[i])) {
+                lastStatus = 0;  // Built-ins that can fail set it themselves.
+                runBuiltIn(&stages[i], currentDir);
+                exit(lastStatus);
+            }
+            printf("ERROR: %s: command not found\n", stages[i].command);
+            exit(127);
+        } else if (child_pid < 0) {
+            printf("ERROR: can't create process\n");
+            if (fds[0] != -1) close(fds[0]);
+            if (fds[1] != -1) close(fds[1]);
+            break;
         }
 
+        pids[started++] = child_pid;  // 0 for a stage that failed to spawn, skipped by the wait below.
+        // The parent keeps no pipe ends, otherwise readers never see EOF.
+        if (prevRead != -1) close(prevRead);
+        if (fds[1] != -1) close(fds[1]);
+        prevRead = fds[0];
+    }
+    if (prevRead != -1) close(prevRead);
+
+    if (jobText != NULL) {
+        if (nJobs == jobsCap) {
+            jobsCap = jobsCap ? jobsCap * 2 : 8;
+            jobs = (Job *) realloc(jobs, jobsCap * sizeof(Job));
+            if (jobs == NULL) {
+                perror("Memory allocation faild");
+                exit(EXIT_FAILURE);
+            }
+        }
+        Job *job = &jobs[nJobs++];
+        job->id = nJobs > 1 ? jobs[nJobs - 2].id + 1 : 1;
+        job->cmdline = jobText;
+        job->pids = pids;
+        job->nStages = nStages;
+        job->running = 0;
+        job->status = started < nStages ? 1 : status;
+        pid_t lastPid = 0;
+        for (int i = 0; i < started; i++) {
+            if (pids[i] != 0) {
+                job->running++;
+                lastPid = pids[i];
+            }
+        }
+        if (interactive) printf("[%d] %d\n", job->id, lastPid);
         return 0;
+    }
+
+    // Wait for the whole pipeline, the last stage decides the status.
+    for (int i = 0; i < started; i++) {
+        int childStatus;
+        if (pids[i] == 0 || waitpid(pids[i], &childStatus, 0) < 0) continue;
+        if (i == nStages - 1) {
+            status = WIFEXITED(childStatus) ? WEXITSTATUS(childStatus) : 128 + WTERMSIG(childStatus);
+        }
+    }
+    if (started < nStages) status = 1;
+
+    free(pids);
+    return status;
+}
+
+// Start an external pipeline stage with posix_spawn(): the pipe ends and the `<`, `>` and `2>`
+// redirections become file actions performed in the child before exec.
+// Returns the child pid, or minus the exit status to report if it could not be started.
+pid_t spawnStage(ParsedCommand *cmd, const char *path, int inFd, int outFd) {
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    // dup2() clears O_CLOEXEC on the copy, the original pipe fds close on exec.
+    if (inFd != -1) posix_spawn_file_actions_adddup2(&actions, inFd, STDIN_FILENO);
+    if (outFd != -1) posix_spawn_file_actions_adddup2(&actions, outFd, STDOUT_FILENO);
+    // Same order as applyRedirections(), files win over pipes.
+    if (cmd->stdoutFile) {
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, cmd->stdoutFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    if (cmd->stderrFile) {
+        posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, cmd->stderrFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    if (cmd->stdinFile) posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, cmd->stdinFile, O_RDONLY, 0);
+
+    // The shell keeps SIGCHLD blocked, the program gets the mask the shell started with.
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setsigmask(&attr, &shellSigMask);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+
+    pid_t pid;
+    int err = posix_spawn(&pid, path, &actions, &attr, cmd->argArr, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    if (err != 0) {
+        // glibc reports failed file actions and exec errors here, the child is already reaped.
+        printf("ERROR: %s: %s\n", cmd->command, strerror(err));
+        if (access(path, F_OK) != 0) return -127;          // The program itself is missing.
+        if (err == EACCES || err == ENOEXEC) return -126;  // Found but not runnable...
+        return -1;                                         // ...or a redirection failed.
+    }
+    return pid;
+}
+
+// Return the next line (NUL-terminated, without '\n'), or NULL at end of input.
+// The line lives in the reader's buffer until the next call. While no full line is buffered,
+// waits on stdin and the SIGCHLD signalfd, so finished jobs are reaped even at an idle prompt.
+char *readLine(InputBuffer *in) {
+    while (1) {
+        // Nothing buffered yet (data is still NULL before the first read): nothing to scan.
+        char *newline = in->end > in->start ? memchr(in->data + in->start, '\n', in->end - in->start) : NULL;
+        if (newline != NULL) {
+            char *line = in->data + in->start;
+            *newline = '\0';
+            in->start = newline + 1 - in->data;
+            return line;
+        }
+        if (in->eof) {
+            if (in->start == in->end) return NULL;
+            char *line = in->data + in->start;  // Last line without a newline, end always leaves room for the NUL.
+            in->data[in->end] = '\0';
+            in->start = in->end;
+            return line;
+        }
+
+        // Make room: drop consumed bytes first, grow only for a line longer than the buffer.
+        if (in->start > 0) {
+            memmove(in->data, in->data + in->start, in->end - in->start);
+            in->end -= in->start;
+            in->start = 0;
+        }
+        if (in->cap - in->end < 2) {
+            in->cap = in->cap ? in->cap * 2 : 65536;
+            if ((in->data = (char *) realloc(in->data, in->cap)) == NULL) {
+                perror("Memory allocation faild");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        struct pollfd fds[2] = {{in->fd, POLLIN, 0}, {childFd, POLLIN, 0}};
+        if (poll(fds, in->reapJobs && childFd >= 0 ? 2 : 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            exit(EXIT_FAILURE);
+        }
+        if (fds[1].revents & POLLIN) reapChildren();
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t n = read(in->fd, in->data + in->end, in->cap - in->end - 1);
+            if (n > 0) {
+                in->end += n;
+            } else if (n == 0 || errno != EINTR) {
+                in->eof = 1;
+            }
+        }
+    }
+}
+
+// Remove a trailing `&` (and the blanks around it) from the line. Returns 1 if there was one.
+int stripBackground(char line[]) {
+    size_t len = strlen(line);
+    while (len > 0 && (line[len - 1] == ' ' || line[len - 1] == '\t')) len--;
+    if (len == 0 || line[len - 1] != '&') return 0;
+    len--;
+    while (len > 0 && (line[len - 1] == ' ' || line[len - 1] == '\t')) len--;
+    line[len] = '\0';
+    return 1;
+}
+
+// Record the end of one stage of a job.
+static void markReaped(pid_t pid, int childStatus) {
+    for (int j = 0; j < nJobs; j++) {
+        for (int i = 0; i < jobs[j].nStages; i++) {
+            if (jobs[j].pids[i] != pid) continue;
+            jobs[j].pids[i] = 0;
+            jobs[j].running--;
+            if (i == jobs[j].nStages - 1) {
+                jobs[j].status = WIFEXITED(childStatus) ? WEXITSTATUS(childStatus) : 128 + WTERMSIG(childStatus);
+            }
+            return;
+        }
+    }
+}
+
+// Drain the SIGCHLD signalfd and reap every child that has exited.
+// Only called while no foreground pipeline is running, so every child found belongs to a job.
+void reapChildren(void) {
+    struct signalfd_siginfo info[16];
+    while (read(childFd, info, sizeof(info)) > 0) {
+        // Signals coalesce, the waitpid() loop below is what counts.
+    }
+    int childStatus;
+    pid_t pid;
+    while ((pid = waitpid(-1, &childStatus, WNOHANG)) > 0) markReaped(pid, childStatus);
+}
+
+// Report finished jobs (before the prompt, like sh) and drop them from the table.
+// report = 0 drops them silently.
+void notifyJobs(int report) {
+    reapChildren();
+    for (int j = 0; j < nJobs;) {
+        if (jobs[j].running > 0) {
+            j++;
+            continue;
+        }
+        if (!report) {
+            // Dropped without a notice.
+        } else if (jobs[j].status == 0) {
+            printf("[%d]  Done\t\t%s\n", jobs[j].id, jobs[j].cmdline);
+        } else {
+            printf("[%d]  Exit %d\t\t%s\n", jobs[j].id, jobs[j].status, jobs[j].cmdline);
+        }
+        removeJob(&jobs[j]);
+    }
+}
+
+// Block until every stage of the job has exited, returns its status.
+int waitJob(Job *job) {
+    for (int i = 0; i < job->nStages; i++) {
+        int childStatus;
+        pid_t pid = job->pids[i];
+        if (pid != 0 && waitpid(pid, &childStatus, 0) == pid) markReaped(pid, childStatus);
+    }
+    return job->status;
+}
+
+// `%N` (job number), a pid of one of the job's stages, or NULL for the most recent job.
+Job *findJob(const char *spec) {
+    if (spec == NULL) return nJobs > 0 ? &jobs[nJobs - 1] : NULL;
+    long wanted = strtol(spec[0] == '%' ? spec + 1 : spec, NULL, 10);
+    for (int j = 0; j < nJobs; j++) {
+        if (spec[0] == '%' && jobs[j].id == wanted) return &jobs[j];
+        for (int i = 0; spec[0] != '%' && i < jobs[j].nStages; i++) {
+            if (jobs[j].pids[i] == wanted) return &jobs[j];
+        }
+    }
+    return NULL;
+}
+
+void removeJob(Job *job) {
+    free(job->cmdline);
+    free(job->pids);
+    int index = job - jobs;
+    memmove(&jobs[index], &jobs[index + 1], (nJobs - index - 1) * sizeof(Job));
+    nJobs--;
+}
+
+// built-in `jobs` command: list running and finished background jobs.
+void jobsBuiltIn(char *args[]) {
+    (void) args;
+    reapChildren();
+    for (int j = 0; j < nJobs; j++) {
+        if (jobs[j].running > 0) printf("[%d]  Running\t\t%s\n", jobs[j].id, jobs[j].cmdline);
+    }
+    notifyJobs(1);  // Prints the finished ones and forgets them.
+}
+
+// built-in `wait` command: wait for all jobs, or the ones given as %N / pid. Returns the last status.
+int waitBuiltIn(char *args[]) {
+    int status = 0;
+    if (args[1] == NULL) {
+        while (nJobs > 0) {
+            status = waitJob(&jobs[0]);
+            removeJob(&jobs[0]);
+        }
+        return status;
+    }
+    for (int i = 1; args[i] != NULL; i++) {
+        Job *job = findJob(args[i]);
+        if (job == NULL) {
+            printf("wait: %s: no such job\n", args[i]);
+            status = 127;
+            continue;
+        }
+        status = waitJob(job);
+        removeJob(job);
+    }
+    return status;
+}
+
+// built-in `fg` command: bring a job (default: the most recent one) to the foreground and wait for it.
+// The shell does no terminal job control, so this is a `wait` that shows what it waits for.
+int fgBuiltIn(char *args[]) {
+    Job *job = findJob(args[1]);
+    if (job == NULL) {
+        printf("fg: %s: no such job\n", args[1] ? args[1] : "current");
+        return 1;
+    }
+    printf("%s\n", job->cmdline);
+    fflush(stdout);
+    int status = waitJob(job);
+    removeJob(job);
+    return status;
+}
+
+// Copy everything from inFd to outFd inside the kernel when possible:
+// copy_file_range() (file to file, reflinks on filesystems that can), then sendfile() (from a file),
+// then splice() (to or from a pipe), and read()/write() through a buffer only for what's left (ttys).
+// Returns -1 with errno set on failure.
+int copyFd(int inFd, int outFd) {
+    enum { COPY_RANGE, SEND_FILE, SPLICE, READ_WRITE } method = COPY_RANGE;
+    const size_t chunk = 1 << 30;  // Per call, the kernel caps a single transfer below 2 GiB anyway.
+    char *buffer = NULL;
+
+    while (1) {
+        ssize_t n;
+        switch (method) {
+            case COPY_RANGE:
+                n = copy_file_range(inFd, NULL, outFd, NULL, chunk, 0);
+                break;
+            case SEND_FILE:
+                n = sendfile(outFd, inFd, NULL, chunk);
+                break;
+            case SPLICE:
+                n = splice(inFd, NULL, outFd, NULL, chunk, SPLICE_F_MOVE | SPLICE_F_MORE);
+                break;
+            default:
+                if (buffer == NULL && (buffer = (char *) malloc(65536)) == NULL) return -1;
+                n = read(inFd, buffer, 65536);
+                for (ssize_t done = 0; n > 0 && done < n;) {
+                    ssize_t written = write(outFd, buffer + done, n - done);
+                    if (written < 0) {
+                        if (errno == EINTR) continue;
+                        free(buffer);
+                        return -1;
+                    }
+                    done += written;
+                }
+                break;
+        }
+
+        if (n > 0) continue;
+        if (n == 0) break;  // End of input.
+        if (errno == EINTR || errno == EAGAIN) continue;
+        // This pair of fds doesn't support the method (different filesystems, not a file, not a pipe...):
+        // fall through to the next one. Nothing was transferred by the failed call.
+        if (method != READ_WRITE && (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP ||
+                                     errno == EBADF || errno == ESPIPE)) {
+            method++;
+            continue;
+        }
+        free(buffer);
+        return -1;
+    }
+    free(buffer);
+    return 0;
+}
+
+// built-in `cat` command: copy each file (or stdin) to stdout without leaving the shell.
+int catBuiltIn(char *args[]) {
+    int status = 0;
+    fflush(stdout);  // Raw writes to fd 1 must come after what printf() still holds.
+    if (args[1] == NULL) return copyFd(STDIN_FILENO, STDOUT_FILENO) < 0 ? 1 : 0;
+    for (int i = 1; args[i] != NULL; i++) {
+        if (strcmp(args[i], "-") == 0) {
+            if (copyFd(STDIN_FILENO, STDOUT_FILENO) < 0) status = 1;
+            continue;
+        }
+        int fd = open(args[i], O_RDONLY | O_CLOEXEC);
+        if (fd < 0 || copyFd(fd, STDOUT_FILENO) < 0) {
+            fprintf(stderr, "cat: %s: %s\n", args[i], strerror(errno));
+            status = 1;
+        }
+        if (fd >= 0) close(fd);
+    }
+    return status;
+}
+
+// built-in `cp` command: `cp src dst` or `cp src... dir`. With options (-r, -p, ...) runsBuiltIn()
+// sends the line to /bin/cp instead.
+int cpBuiltIn(char *args[]) {
+    int count = 0;
+    while (args[count + 1] != NULL) count++;
+    if (count < 2 || args[1][0] == '-') {
+        printf("usage: cp src dst | cp src... dir\n");
+        return 1;
+    }
+
+    const char *target = args[count];
+    struct stat targetStat;
+    int toDir = stat(target, &targetStat) == 0 && S_ISDIR(targetStat.st_mode);
+    if (count > 2 && !toDir) {
+        fprintf(stderr, "cp: target '%s' is not a directory\n", target);
+        return 1;
+    }
+
+    int status = 0;
+    for (int i = 1; i < count; i++) {
+        int inFd = open(args[i], O_RDONLY | O_CLOEXEC);
+        struct stat srcStat;
+        if (inFd < 0 || fstat(inFd, &srcStat) < 0 || S_ISDIR(srcStat.st_mode)) {
+            fprintf(stderr, "cp: %s: %s\n", args[i], inFd < 0 ? strerror(errno) : "is a directory (use /bin/cp -r)");
+            if (inFd >= 0) close(inFd);
+            status = 1;
+            continue;
+        }
+
+        char *dest = (char *) target;
+        if (toDir) {
+            char *srcCopy = strdup(args[i]);
+            const char *name = basename(srcCopy);
+            dest = (char *) malloc(strlen(target) + strlen(name) + 2);
+            sprintf(dest, "%s/%s", target, name);
+            free(srcCopy);
+        }
+        // Truncate only after checking the destination is not the source itself (`cp f .`).
+        int outFd = open(dest, O_WRONLY | O_CREAT | O_CLOEXEC, srcStat.st_mode & 0777);
+        struct stat destStat;
+        if (outFd >= 0 && fstat(outFd, &destStat) == 0 && destStat.st_dev == srcStat.st_dev &&
+            destStat.st_ino == srcStat.st_ino) {
+            fprintf(stderr, "cp: '%s' and '%s' are the same file\n", args[i], dest);
+            status = 1;
+        } else if (outFd < 0 || ftruncate(outFd, 0) < 0 || copyFd(inFd, outFd) < 0) {
+            fprintf(stderr, "cp: %s: %s\n", dest, strerror(errno));
+            status = 1;
+        }
+        if (outFd >= 0) close(outFd);
+        close(inFd);
+        if (dest != target) free(dest);
+    }
+    return status;
+}
+
+// Open (or create) the history file. It is mapped and indexed on first use (historySync()),
+// so startup costs the same with ten entries or ten million.
+void historyOpen(History *h, const char *path) {
+    h->fd = open(path, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0600);  // On failure: no history.
+    if (h->fd < 0) return;
+    h->indexPath = (char *) malloc(strlen(path) + sizeof(".idx"));
+    if (h->indexPath != NULL) sprintf(h->indexPath, "%s.idx", path);
+}
+
+static void historySortIndex(History *h);
+
+// Append one command with a single write(): O_APPEND keeps lines from concurrent shells whole.
+// Every HISTORY_MERGE_LINES appends the sorted index (and its sidecar) is brought up to date,
+// so the sort work is spread over the appends instead of landing on a search.
+void historyAppend(History *h, const char *line) {
+    size_t len = strlen(line);
+    char *record = (char *) malloc(len + 1);
+    if (record == NULL) return;
+    memcpy(record, line, len);
+    record[len] = '\n';
+    if (write(h->fd, record, len + 1) < 0) perror("history");
+    free(record);
+    if (++h->unsaved >= HISTORY_MERGE_LINES) {
+        h->unsaved = 0;
+        historySync(h);
+        historySortIndex(h);
+    }
+}
+
+// Map bytes appended since the last call (by this shell or another one) and index their lines.
+void historySync(History *h) {
+    struct stat st;
+    if (fstat(h->fd, &st) < 0 || (size_t) st.st_size <= h->mappedSize) return;
+
+    void *map = h->map ? mremap(h->map, h->mappedSize, st.st_size, MREMAP_MAYMOVE)
+                       : mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, h->fd, 0);
+    if (map == MAP_FAILED) return;
+    h->map = (char *) map;
+    h->mappedSize = st.st_size;
+
+    // Only complete lines, a concurrent append may still be in flight.
+    char *end;
+    while ((end = memchr(h->map + h->indexedSize, '\n', h->mappedSize - h->indexedSize)) != NULL) {
+        if (h->nLines == h->linesCap) {
+            h->linesCap = h->linesCap ? h->linesCap * 2 : 1024;
+            size_t *grown = (size_t *) realloc(h->lines, h->linesCap * sizeof(size_t));
+            if (grown == NULL) return;
+            h->lines = grown;
+        }
+        h->lines[h->nLines++] = h->indexedSize;
+        h->indexedSize = end + 1 - h->map;
+    }
+}
+
+// Order history lines by text ('\n' terminated), then by age so the newest of equal lines is last.
+static int compareHistoryLines(const void *a, const void *b, void *arg) {
+    const History *h = (const History *) arg;
+    size_t offsetA = *(const size_t *) a, offsetB = *(const size_t *) b;
+    const unsigned char *x = (const unsigned char *) h->map + offsetA;
+    const unsigned char *y = (const unsigned char *) h->map + offsetB;
+    while (*x == *y && *x != '\n') {
+        x++;
+        y++;
+    }
+    if (*x != *y) return *x == '\n' ? -1 : *y == '\n' ? 1 : *x - *y;
+    return offsetA < offsetB ? -1 : offsetA > offsetB;
+}
+
+// Sidecar index file: this header, then `count` offsets (sorted[]) of the lines in the
+// first `covered` bytes of the history file.
+typedef struct {
+    char magic[8];
+    unsigned long long inode;  // Of the history file, a replaced file invalidates the index.
+    unsigned long long covered;
+    unsigned long long count;
+    unsigned long long tailHash;  // Of the last bytes covered, catches a file rewritten in place.
+} HistoryIndexHeader;
+
+static const char historyIndexMagic[8] = "MHIDX01";
+
+// FNV-1a of the (up to) 4 KiB of history before offset end.
+static unsigned long long historyTailHash(const History *h, size_t end) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = end > 4096 ? end - 4096 : 0; i < end; i++) {
+        hash ^= (unsigned char) h->map[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Fill the max-offset tree: newest[n + i] = sorted[i], every inner node the larger child.
+static void historyBuildNewest(History *h) {
+    size_t n = h->nSorted;
+    free(h->newest);
+    if ((h->newest = (size_t *) malloc(2 * n * sizeof(size_t))) == NULL) return;
+    memcpy(h->newest + n, h->sorted, n * sizeof(size_t));
+    for (size_t i = n - 1; i > 0; i--) {
+        h->newest[i] = h->newest[2 * i] > h->newest[2 * i + 1] ? h->newest[2 * i] : h->newest[2 * i + 1];
+    }
+}
+
+// Newest line (largest offset) in sorted[first .. last), or -1 for an empty range.
+static long historyNewestIn(const History *h, size_t first, size_t last) {
+    long newest = -1;
+    if (h->newest == NULL) {  // No tree (out of memory): scan.
+        for (size_t i = first; i < last; i++) {
+            if ((long) h->sorted[i] > newest) newest = h->sorted[i];
+        }
+        return newest;
+    }
+    // Bottom-up: climb both ends, taking a node whenever it is not shared with the outside.
+    for (first += h->nSorted, last += h->nSorted; first < last; first /= 2, last /= 2) {
+        if (first & 1) {
+            if ((long) h->newest[first] > newest) newest = h->newest[first];
+            first++;
+        }
+        if (last & 1) {
+            last--;
+            if ((long) h->newest[last] > newest) newest = h->newest[last];
+        }
+    }
+    return newest;
+}
+
+// Read the sidecar into sorted[] if it matches the history file: same inode, same bytes just
+// before `covered`, and exactly the lines before it, which appends cannot have changed since.
+static void historyLoadIndex(History *h) {
+    h->indexLoaded = 1;
+    FILE *file = h->indexPath ? fopen(h->indexPath, "r") : NULL;
+    if (file == NULL) return;
+    struct stat st;
+    HistoryIndexHeader header;
+    size_t *sorted = NULL;
+    if (fstat(h->fd, &st) == 0 && fread(&header, sizeof(header), 1, file) == 1 &&
+        memcmp(header.magic, historyIndexMagic, sizeof(historyIndexMagic)) == 0 && header.inode == st.st_ino &&
+        header.count > 0 && header.count <= h->nLines && header.covered <= h->indexedSize &&
+        (header.count == h->nLines ? header.covered == h->indexedSize : h->lines[header.count] == header.covered) &&
+        historyTailHash(h, header.covered) == header.tailHash &&
+        (sorted = (size_t *) malloc(header.count * sizeof(size_t))) != NULL &&
+        fread(sorted, sizeof(size_t), header.count, file) == header.count) {
+        size_t i = 0;
+        while (i < header.count && sorted[i] < header.covered) i++;
+        if (i == header.count) {
+            h->sorted = sorted;
+            h->nSorted = header.count;
+            sorted = NULL;
+            historyBuildNewest(h);
+        }
+    }
+    free(sorted);
+    fclose(file);
+}
+
+// Write sorted[] to the sidecar: to a private temporary name, then rename(), so a concurrent
+// shell reads either the old index or the new one, never half of one.
+static void historySaveIndex(History *h) {
+    struct stat st;
+    if (h->indexPath == NULL || fstat(h->fd, &st) < 0) return;
+    char *tmpPath = (char *) malloc(strlen(h->indexPath) + 24);
+    if (tmpPath == NULL) return;
+    sprintf(tmpPath, "%s.%d", h->indexPath, (int) getpid());
+    HistoryIndexHeader header;
+    memcpy(header.magic, historyIndexMagic, sizeof(header.magic));
+    header.inode = st.st_ino;
+    header.covered = h->nSorted == h->nLines ? h->indexedSize : h->lines[h->nSorted];
+    header.count = h->nSorted;
+    header.tailHash = historyTailHash(h, header.covered);
+    int fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);  // Private, like the history.
+    FILE *file = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (fd >= 0 && file == NULL) close(fd);
+    if (file != NULL) {
+        int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                 fwrite(h->sorted, sizeof(size_t), h->nSorted, file) == h->nSorted;
+        if (fclose(file) == 0 && ok) rename(tmpPath, h->indexPath);
+    }
+    unlink(tmpPath);  // Only still there if something failed.
+    free(tmpPath);
+}
+
+// Bring the sorted index up to date: start from the sidecar, sort only the lines it does not
+// cover, merge them in and save the result. A short unsorted tail is cheaper to scan than a
+// merge of the whole index after every command.
+static void historySortIndex(History *h) {
+    if (!h->indexLoaded) historyLoadIndex(h);
+    if (h->nLines == h->nSorted || (h->nSorted > 0 && h->nLines - h->nSorted < HISTORY_MERGE_LINES)) return;
+    size_t nNew = h->nLines - h->nSorted;
+    size_t *fresh = (size_t *) malloc(nNew * sizeof(size_t));
+    size_t *merged = (size_t *) malloc(h->nLines * sizeof(size_t));
+    if (fresh == NULL || merged == NULL) {
+        free(fresh);
+        free(merged);
+        return;
+    }
+    memcpy(fresh, h->lines + h->nSorted, nNew * sizeof(size_t));
+    qsort_r(fresh, nNew, sizeof(size_t), compareHistoryLines, h);
+
+    size_t i = 0, j = 0, k = 0;
+    while (i < h->nSorted && j < nNew) {
+        merged[k++] = compareHistoryLines(&h->sorted[i], &fresh[j], h) <= 0 ? h->sorted[i++] : fresh[j++];
+    }
+    while (i < h->nSorted) merged[k++] = h->sorted[i++];
+    while (j < nNew) merged[k++] = fresh[j++];
+    free(fresh);
+    free(h->sorted);
+    h->sorted = merged;
+    h->nSorted = h->nLines;
+    historyBuildNewest(h);
+    historySaveIndex(h);
+}
+
+// Compare the start of a history line with prefix: <0, 0 (line starts with prefix) or >0.
+static int comparePrefix(History *h, size_t offset, const char *prefix, size_t prefixLen) {
+    const char *text = h->map + offset;
+    size_t len = (char *) memchr(text, '\n', h->mappedSize - offset) - text;
+    int cmp = memcmp(text, prefix, len < prefixLen ? len : prefixLen);
+    if (cmp == 0 && len < prefixLen) return -1;
+    return cmp;
+}
+
+// Binary search the lines starting with prefix: they are sorted[*first .. *last), plus any
+// matches in the unsorted tail lines[nSorted ..). Returns the offset of the newest match, or -1.
+long historyFind(History *h, const char *prefix, size_t prefixLen, size_t *first, size_t *last) {
+    historySync(h);
+    historySortIndex(h);
+
+    size_t lo = 0, hi = h->nSorted;
+    while (lo < hi) {  // First line >= prefix.
+        size_t mid = lo + (hi - lo) / 2;
+        if (comparePrefix(h, h->sorted[mid], prefix, prefixLen) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *first = lo;
+    hi = h->nSorted;
+    while (lo < hi) {  // First line after the ones starting with prefix.
+        size_t mid = lo + (hi - lo) / 2;
+        if (comparePrefix(h, h->sorted[mid], prefix, prefixLen) <= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *last = lo;
+
+    // The tail is newer than every indexed line.
+    for (size_t i = h->nLines; i > h->nSorted; i--) {
+        if (comparePrefix(h, h->lines[i - 1], prefix, prefixLen) == 0) return h->lines[i - 1];
+    }
+    return historyNewestIn(h, *first, *last);
+}
+
+// `!!` (last command) or `!prefix rest...` (newest command starting with prefix, then rest).
+// Returns a malloc()ed line, or NULL after printing an error.
+char *historyExpand(History *h, const char *line) {
+    size_t prefixLen = strcspn(line + 1, " \t");
+    long offset;
+    historySync(h);
+    if (line[1] == '!') {
+        prefixLen = 1;
+        offset = h->nLines > 0 ? (long) h->lines[h->nLines - 1] : -1;
     } else {
-        free(localVars[index]->value);
-        localVars[index]->value = strdup(newVar->value);
-        if (localVars[index]->value == NULL) {
-            return -1;
+        size_t first, last;
+        offset = prefixLen > 0 ? historyFind(h, line + 1, prefixLen, &first, &last) : -1;
+    }
+    if (offset < 0) {
+        printf("ERROR: %.*s: event not found\n", (int) prefixLen + 1, line);
+        return NULL;
+    }
+
+    const char *text = h->map + offset;
+    size_t textLen = (char *) memchr(text, '\n', h->mappedSize - offset) - text;
+    const char *rest = line + 1 + prefixLen;
+    char *expanded = (char *) malloc(textLen + strlen(rest) + 1);
+    if (expanded == NULL) return NULL;
+    memcpy(expanded, text, textLen);
+    strcpy(expanded + textLen, rest);
+    return expanded;
+}
+
+// built-in `history` command: `history [N]` lists the last N (all) entries, `history -p prefix` the matching ones.
+void historyBuiltIn(char *args[]) {
+    History *h = &shellHistory;
+    if (h->fd < 0) {
+        printf("history: not available\n");
+        return;
+    }
+    historySync(h);
+
+    if (args[1] != NULL && strcmp(args[1], "-p") == 0) {
+        if (args[2] == NULL) {
+            printf("usage: history -p prefix\n");
+            return;
+        }
+        size_t first, last, prefixLen = strlen(args[2]);
+        historyFind(h, args[2], prefixLen, &first, &last);
+        for (size_t i = first; i < last; i++) {
+            const char *text = h->map + h->sorted[i];
+            fwrite(text, 1, (char *) memchr(text, '\n', h->mappedSize - h->sorted[i]) - text + 1, stdout);
+        }
+        for (size_t i = h->nSorted; i < h->nLines; i++) {
+            if (comparePrefix(h, h->lines[i], args[2], prefixLen) != 0) continue;
+            const char *text = h->map + h->lines[i];
+            fwrite(text, 1, (char *) memchr(text, '\n', h->mappedSize - h->lines[i]) - text + 1, stdout);
         }
+        return;
+    }
+
+    size_t start = 0;
+    if (args[1] != NULL) {
+        long count = atol(args[1]);
+        if (count >= 0 && (size_t) count < h->nLines) start = h->nLines - count;
+    }
+    for (size_t i = start; i < h->nLines; i++) {
+        const char *text = h->map + h->lines[i];
+        printf("%5zu  ", i + 1);
+        fwrite(text, 1, (char *) memchr(text, '\n', h->mappedSize - h->lines[i]) - text + 1, stdout);
+    }
+}
+
+// Helper Functions for the string hash map.
+
+// FNV-1a string hash.
+unsigned long hashString(const char *str) {
+    unsigned long hash = 14695981039346656037UL;
+    while (*str) {
+        hash ^= (unsigned char) *str++;
+        hash *= 1099511628211UL;
+    }
+    return hash;
+}
+
+// Slot holding `key`, or the empty slot where it would go.
+static StrMapEntry *mapFind(StrMap *map, const char *key, unsigned long hash) {
+    size_t mask = map->capacity - 1;
+    size_t i = hash & mask;
+    while (map->slots[i].key != NULL) {
+        if (map->slots[i].hash == hash && strcmp(map->slots[i].key, key) == 0) break;
+        i = (i + 1) & mask;
+    }
+    return &map->slots[i];
+}
+
+// Double the table (or create it), re-inserting every entry.
+static int mapGrow(StrMap *map) {
+    size_t newCapacity = map->capacity ? map->capacity * 2 : 16;
+    StrMapEntry *newSlots = (StrMapEntry *) calloc(newCapacity, sizeof(StrMapEntry));
+    if (newSlots == NULL) return -1;
+
+    StrMap grown = {newSlots, newCapacity, map->count, map->arena};
+    for (size_t i = 0; i < map->capacity; i++) {
+        if (map->slots[i].key != NULL) {
+            *mapFind(&grown, map->slots[i].key, map->slots[i].hash) = map->slots[i];
+        }
+    }
+    free(map->slots);
+    *map = grown;
+    return 0;
+}
+
+char *mapGet(StrMap *map, const char *key) {
+    if (map->count == 0) return NULL;
+    StrMapEntry *entry = mapFind(map, key, hashString(key));
+    return entry->key ? entry->value : NULL;
+}
+
+int mapPut(StrMap *map, const char *key, const char *value) {
+    // Keep the load factor under 3/4 so probe chains stay short.
+    if ((map->count + 1) * 4 > map->capacity * 3 && mapGrow(map) < 0) return -1;
+
+    unsigned long hash = hashString(key);
+    StrMapEntry *entry = mapFind(map, key, hash);
+    if (map->arena != NULL) {
+        // Reassignments reuse the old arena bytes when the new value fits.
+        if (entry->key != NULL && strlen(value) <= strlen(entry->value)) {
+            strcpy(entry->value, value);
+            return 0;
+        }
+        char *newValue = arenaStrdup(map->arena, value);
+        if (newValue == NULL) return -1;
+        if (entry->key == NULL) {
+            if ((entry->key = arenaStrdup(map->arena, key)) == NULL) return -1;
+            entry->hash = hash;
+            map->count++;
+        }
+        entry->value = newValue;
         return 0;
     }
 
-    return -1;  // shouldn't reach here.
+    char *newValue = strdup(value);
+    if (newValue == NULL) return -1;
+    if (entry->key == NULL) {
+        if ((entry->key = strdup(key)) == NULL) {
+            free(newValue);
+            return -1;
+        }
+        entry->hash = hash;
+        map->count++;
+    } else {
+        free(entry->value);
+    }
+    entry->value = newValue;
+    return 0;
+}
+
+void mapDelete(StrMap *map, const char *key) {
+    if (map->count == 0) return;
+    size_t mask = map->capacity - 1;
+    StrMapEntry *entry = mapFind(map, key, hashString(key));
+    if (entry->key == NULL) return;
+    if (map->arena == NULL) {
+        free(entry->key);
+        free(entry->value);
+    }
+    map->count--;
+
+    // Backward-shift deletion: move later entries of the probe chain into the hole (no tombstones).
+    size_t hole = entry - map->slots;
+    size_t i = (hole + 1) & mask;
+    while (map->slots[i].key != NULL) {
+        size_t home = map->slots[i].hash & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            map->slots[hole] = map->slots[i];
+            hole = i;
+        }
+        i = (i + 1) & mask;
+    }
+    map->slots[hole].key = NULL;
+    map->slots[hole].value = NULL;
 }
 
-int searchLocalVar(shellLocalVar *arr[], char *key) {
-    int i = 0;
-    while (arr[i] != NULL && i < 100) {
-        if (strcmp(arr[i]->key, key) == 0) {
-            return i;
+void mapClear(StrMap *map) {
+    for (size_t i = 0; i < map->capacity; i++) {
+        if (map->slots[i].key != NULL) {
+            if (map->arena == NULL) {
+                free(map->slots[i].key);
+                free(map->slots[i].value);
+            }
+            map->slots[i].key = NULL;
+            map->slots[i].value = NULL;
         }
-        i++;
     }
+    map->count = 0;
+}
+
+// Carve size bytes from the arena, starting a new block (64 KiB, or bigger for a huge string) when full.
+char *arenaAlloc(Arena *arena, size_t size) {
+    ArenaBlock *block = arena->head;
+    if (block == NULL || block->size - block->used < size) {
+        size_t blockSize = size > 65536 ? size : 65536;
+        if ((block = (ArenaBlock *) malloc(sizeof(ArenaBlock) + blockSize)) == NULL) return NULL;
+        block->next = arena->head;
+        block->used = 0;
+        block->size = blockSize;
+        arena->head = block;
+    }
+    char *memory = block->data + block->used;
+    block->used += size;
+    return memory;
+}
+
+// Copy a string into the arena.
+char *arenaStrdup(Arena *arena, const char *str) {
+    size_t len = strlen(str) + 1;
+    char *copy = arenaAlloc(arena, len);
+    if (copy != NULL) memcpy(copy, str, len);
+    return copy;
+}
+
+// Drop everything in the arena but keep its newest block for reuse.
+void arenaReset(Arena *arena) {
+    if (arena->head == NULL) return;
+    ArenaBlock *block = arena->head->next;
+    while (block != NULL) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head->next = NULL;
+    arena->head->used = 0;
+}
+
+// Find the absolute path of a command, searching PATH only the first time.
+// Returns NULL if it isn't an executable file in any PATH directory.
+char *resolveCommand(const char *name) {
+    if (strchr(name, '/') != NULL) return (char *) name;  // Explicit path, nothing to search.
+
+    char *cached = mapGet(&commandCache, name);
+    if (cached != NULL) return cached;
+
+    const char *path = getEnvVarValue("PATH");
+    if (path == NULL) path = "/usr/local/bin:/usr/bin:/bin";
+
+    size_t nameLen = strlen(name);
+    while (*path) {
+        size_t dirLen = strcspn(path, ":");
+        char *candidate = (char *) malloc(dirLen + nameLen + 3);
+        if (candidate == NULL) return NULL;
+        // An empty PATH entry means the current directory.
+        if (dirLen == 0) {
+            strcpy(candidate, ".");
+        } else {
+            memcpy(candidate, path, dirLen);
+            candidate[dirLen] = '\0';
+        }
+        strcat(candidate, "/");
+        strcat(candidate, name);
+
+        struct stat st;
+        if (stat(candidate, &st) == 0 && S_ISREG(st.st_mode) && access(candidate, X_OK) == 0) {
+            int added = mapPut(&commandCache, name, candidate);
+            free(candidate);
+            return added == 0 ? mapGet(&commandCache, name) : NULL;
+        }
+        free(candidate);
 
-    return -1;
+        path += dirLen;
+        if (*path == ':') path++;
+    }
+    return NULL;
 }
 
-// Function to search for a variable in environment variables
+// built-in `hash` command: list the cache, `hash -r` clears it, `hash name...` looks names up now.
+void hashBuiltIn(char *args[]) {
+    if (args[1] != NULL && strcmp(args[1], "-r") == 0) {
+        mapClear(&commandCache);
+        return;
+    }
+    if (args[1] != NULL) {
+        for (int i = 1; args[i] != NULL; i++) {
+            if (resolveCommand(args[i]) == NULL) printf("hash: %s: not found\n", args[i]);
+        }
+        return;
+    }
+    if (commandCache.count == 0) {
+        printf("hash: hash table empty\n");
+        return;
+    }
+    for (size_t i = 0; i < commandCache.capacity; i++) {
+        if (commandCache.slots[i].key != NULL) {
+            printf("%s\t%s\n", commandCache.slots[i].key, commandCache.slots[i].value);
+        }
+    }
+}
+
+// Check if command is built-in Helper Function.
+int isBuiltIn(char *cmd) {
+    return strcmp(cmd, "echo") == 0 || strcmp(cmd, "pwd") == 0 || strcmp(cmd, "cd") == 0 || strcmp(cmd, "exit") == 0 ||
+           strcmp(cmd, "export") == 0 || strcmp(cmd, "unset") == 0 || strcmp(cmd, "hash") == 0 ||
+           strcmp(cmd, "jobs") == 0 || strcmp(cmd, "wait") == 0 || strcmp(cmd, "fg") == 0 ||
+           strcmp(cmd, "cat") == 0 || strcmp(cmd, "cp") == 0 || strcmp(cmd, "history") == 0 ||
+           strcmp(cmd, "parallel") == 0;
+}
+
+// cat and cp are only built in for plain file arguments (a lone "-" is stdin), any option
+// runs the real program so `cat -n` or `cp -r` keep working.
+int runsBuiltIn(ParsedCommand *cmd) {
+    if (!isBuiltIn(cmd->command)) return 0;
+    if (strcmp(cmd->command, "cat") != 0 && strcmp(cmd->command, "cp") != 0) return 1;
+    for (int i = 1; cmd->argArr[i] != NULL; i++) {
+        if (cmd->argArr[i][0] == '-' && cmd->argArr[i][1] != '\0') return 0;
+    }
+    return 1;
+}
+
+// Function to search for a variable in environment variables (one hash lookup in envIndex).
 char *getEnvVarValue(const char *key) {
     if (key == NULL) return NULL;
+    if (!envIndexed) buildEnvIndex();
+    return mapGet(&envIndex, key);
+}
 
+// Index environ once. Afterwards export/unset patch both environ and the index.
+void buildEnvIndex(void) {
     for (char **env = environ; *env != NULL; env++) {
         char *equal_sign = strchr(*env, '=');
-        if (equal_sign != NULL) {
-            size_t key_len = equal_sign - *env;
-            if (strncmp(*env, key, key_len) == 0 && key[key_len] == '\0') {
-                return equal_sign + 1;
-            }
-        }
+        if (equal_sign == NULL) continue;
+        char *key = strndup(*env, equal_sign - *env);
+        // Like getenv(), the first definition of a duplicated name wins.
+        if (key != NULL && mapGet(&envIndex, key) == NULL) mapPut(&envIndex, key, equal_sign + 1);
+        free(key);
     }
-    return NULL;
+    envIndexed = 1;
 }
 
 // Command line parsing function definition.
-void tokenize(shellLocalVar *localVars[], char buff[], ParsedCommand *cmd) {
-    int i = 0, j = 0, count = 0;
-    cmd->command = NULL;
+// Single pass over the line: tokens are NUL-terminated in place and the ParsedCommand only
+// points into buff (or into the variable stores), so parsing allocates nothing unless a glob
+// has to be expanded. Word ends are found with strspn()/strcspn(), which glibc implements with
+// SIMD byte compares.
+// Returns -1 (after printing the reason) on a syntax error.
+int tokenize(StrMap *localVars, char buff[], ParsedCommand *cmd) {
+    static const char delimiters[] = " \t\n";
+    static char statusText[16];  // Expansion of `$?`, valid until the next line is parsed.
+    char **pendingFile = NULL;   // Redirection operator still waiting for its file name.
+    cmd->argCount = 0;
     cmd->stdoutFile = NULL;
     cmd->stdinFile = NULL;
     cmd->stderrFile = NULL;
+    cmd->isAssignment = 0;
+
+    char *p = buff;
+    while (1) {
+        // Skip leading spaces
+        p += strspn(p, delimiters);
+        if (*p == '\0') break;  // If only spaces are left, stop
+
+        // Find the end of the word and terminate it in place.
+        char *token = p;
+        p += strcspn(p, delimiters);
+        if (*p != '\0') *p++ = '\0';
+
+        if (pendingFile != NULL) {
+            *pendingFile = token;
+            pendingFile = NULL;
+            continue;
+        }
+
+        switch (token[0]) {
+            case '$': {
+                char *key = token + 1;
+                char *value;
+                if (key[0] == '?' && key[1] == '\0') {
+                    snprintf(statusText, sizeof(statusText), "%d", lastStatus);
+                    value = statusText;
+                } else if ((value = mapGet(localVars, key)) == NULL) {  // Points into the arena, nothing to free.
+                    value = getEnvVarValue(key);
+                }
+                addArg(cmd, value != NULL ? value : " ");
+                continue;  // An expanded value is always a plain word.
+            }
+            // Handle redirection, `> file` or inline `>file`.
+            case '>':
+                if (token[1] == '\0') {
+                    pendingFile = &cmd->stdoutFile;
+                } else {
+                    cmd->stdoutFile = token + 1;
+                }
+                continue;
+            case '<':
+                if (token[1] == '\0') {
+                    pendingFile = &cmd->stdinFile;
+                } else {
+                    cmd->stdinFile = token + 1;
+                }
+                continue;
+            case '2':
+                if (token[1] != '>') break;
+                if (token[2] == '\0') {
+                    pendingFile = &cmd->stderrFile;
+                } else {
+                    cmd->stderrFile = token + 2;
+                }
+                continue;
+            default:
+                if (cmd->argCount == 0 && token[0] != '=' && strchr(token, '=') != NULL) cmd->isAssignment = 1;
+                break;
+        }
 
-    // Remove trailing newline from fgets()
-    size_t len = strlen(buff);
-    if (len > 0 && buff[len - 1] == '\n') {
-        buff[len - 1] = '\0';
+        if (strpbrk(token, "*?[") != NULL) {
+            globExpand(token, cmd);
+        } else {
+            addArg(cmd, token);
+        }
     }
 
-    while (buff[j] != '\0') {
-        // Skip leading spaces
-        while (buff[j] == ' ') j++;
+    if (pendingFile != NULL) {
+        printf("ERROR: missing file name after redirection\n");
+        return -1;
+    }
+    addArg(cmd, NULL);  // Null-terminate the array
+    cmd->argCount--;
+    cmd->command = cmd->argArr[0];
+    return 0;
+}
 
-        if (buff[j] == '\0') break;  // If only spaces are left, stop
+// Append one word to the command's argument vector, growing it when full.
+void addArg(ParsedCommand *cmd, char *arg) {
+    if (cmd->argCount == cmd->argCap) {
+        int newCap = cmd->argCap ? cmd->argCap * 2 : 16;
+        char **grown = (char **) realloc(cmd->argArr, newCap * sizeof(char *));
+        if (grown == NULL) {
+            perror("Memory allocation faild");
+            exit(EXIT_FAILURE);
+        }
+        cmd->argArr = grown;
+        cmd->argCap = newCap;
+    }
+    cmd->argArr[cmd->argCount++] = arg;
+}
 
-        i = j;  // Start of word
+// One running `parallel` job: its output is collected here and printed in one piece when it ends.
+typedef struct {
+    pid_t pid;
+    int fd;  // Read end of the pipe holding the job's stdout and stderr, -1 when the slot is free.
+    char *output;
+    size_t length;
+    size_t cap;
+} ParallelJob;
 
-        // Find the end of the word
-        while (buff[j] != ' ' && buff[j] != '\0') {
-            j++;
+// Start the template for one input line: `{}` is replaced by the line, without `{}` the line is
+// appended. Returns 0, or -1 if the job could not be started.
+static int startParallelJob(ParallelJob *job, char **template, const char *path, const char *line, int nullStdin) {
+    int count = 0;
+    while (template[count] != NULL) count++;
+    char **argv = (char **) calloc(count + 2, sizeof(char *));
+    int hasPlaceholder = 0;
+    for (int i = 0; i < count; i++) {
+        char *at = strstr(template[i], "{}");
+        if (at == NULL) {
+            argv[i] = template[i];
+            continue;
         }
+        hasPlaceholder = 1;
+        argv[i] = (char *) malloc(strlen(template[i]) - 2 + strlen(line) + 1);
+        sprintf(argv[i], "%.*s%s%s", (int) (at - template[i]), template[i], line, at + 2);
+    }
+    if (!hasPlaceholder) argv[count] = (char *) line;
 
-        // Only allocate if we have a non-empty token
-        if (j > i) {
-            int tokenLen = j - i;
-            char *token = malloc(tokenLen + 1);
-            if (token == NULL) {
-                perror("Memory allocation faild");
-                exit(EXIT_FAILURE);
-            }
-            // Copy the word
-            strncpy(token, buff + i, tokenLen);
-            token[tokenLen] = '\0';
+    int fds[2];
+    int err = pipe2(fds, O_CLOEXEC);
+    if (err == 0) {
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, fds[1], STDERR_FILENO);
+        // The input lines come from our stdin, jobs must not eat them.
+        if (nullStdin) posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+        posix_spawnattr_setsigmask(&attr, &shellSigMask);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
 
-            if (token[0] == '$') {
-                char *key = token + 1;
-                char *value = NULL;
-                int index;
+        err = posix_spawn(&job->pid, path, &actions, &attr, argv, environ);
+        posix_spawn_file_actions_destroy(&actions);
+        posix_spawnattr_destroy(&attr);
+        close(fds[1]);
+        if (err == 0) {
+            job->fd = fds[0];
+            job->length = 0;
+        } else {
+            close(fds[0]);
+            fprintf(stderr, "parallel: %s: %s\n", path, strerror(err));
+        }
+    } else {
+        perror("pipe2");
+    }
 
-                if ((index = searchLocalVar(localVars, key)) != -1) {
-                    value = (char *) malloc(sizeof(char) * strlen(localVars[index]->value));
-                    strcpy(value, localVars[index]->value);
-                }
+    for (int i = 0; i < count; i++) {
+        if (argv[i] != template[i]) free(argv[i]);
+    }
+    free(argv);
+    return err == 0 ? 0 : -1;
+}
 
-                if (value == NULL) {
-                    value = getEnvVarValue(key);
+// built-in `parallel [-j N] [-a file] cmd args...`: run cmd once per input line (stdin or file),
+// with up to N jobs at a time (default: one per core). Each job's output is printed whole when it
+// ends, so lines of different jobs never interleave. Returns the number of failed jobs (max 101).
+int parallelBuiltIn(char *args[]) {
+    long maxJobs = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *inputFile = NULL;
+    const char *jobsText = NULL;
+    int i = 1;
+    // Options take their value as the next word (-j 4) or attached to the flag (-j4).
+    for (; args[i] != NULL && args[i][0] == '-'; i++) {
+        if (strncmp(args[i], "-j", 2) == 0 && args[i][2] != '\0') {
+            jobsText = args[i] + 2;
+        } else if (strcmp(args[i], "-j") == 0 && args[i + 1] != NULL) {
+            jobsText = args[++i];
+        } else if (strncmp(args[i], "-a", 2) == 0 && args[i][2] != '\0') {
+            inputFile = args[i] + 2;
+        } else if (strcmp(args[i], "-a") == 0 && args[i + 1] != NULL) {
+            inputFile = args[++i];
+        } else {
+            break;
+        }
+    }
+    if (jobsText != NULL) {
+        // Every job holds a slot, a pipe and a poll entry: a typo must not ask for billions of them.
+        char *end;
+        maxJobs = strtol(jobsText, &end, 10);
+        if (end == jobsText || *end != '\0') maxJobs = 0;
+    }
+    if (args[i] == NULL || args[i][0] == '-' || maxJobs < 1 || maxJobs > PARALLEL_MAX_JOBS) {
+        printf("usage: parallel [-j 1..%d] [-a file] command [args...] ({} is replaced by each input line)\n",
+               PARALLEL_MAX_JOBS);
+        return 1;
+    }
+    char **template = &args[i];
+    // Always an external program (like xargs), so `parallel echo {}` runs /bin/echo.
+    const char *path = resolveCommand(template[0]);
+    if (path == NULL) {
+        printf("ERROR: %s: command not found\n", template[0]);
+        return 127;
+    }
+
+    InputBuffer input = {STDIN_FILENO, NULL, 0, 0, 0, 0, 0};
+    if (inputFile != NULL && (input.fd = open(inputFile, O_RDONLY | O_CLOEXEC)) < 0) {
+        perror(inputFile);
+        return 1;
+    }
+    ParallelJob *jobs = (ParallelJob *) calloc(maxJobs, sizeof(ParallelJob));
+    struct pollfd *fds = (struct pollfd *) calloc(maxJobs, sizeof(struct pollfd));
+    int *slotOf = (int *) calloc(maxJobs, sizeof(int));
+    for (long j = 0; j < maxJobs; j++) jobs[j].fd = -1;
+    long running = 0;
+    int failed = 0;
+    fflush(stdout);
+
+    while (1) {
+        // Fill the free slots.
+        for (long j = 0; j < maxJobs && !input.eof; j++) {
+            if (jobs[j].fd >= 0) continue;
+            char *line;
+            while ((line = readLine(&input)) != NULL && line[0] == '\0') {
+                // Skip empty lines.
+            }
+            if (line == NULL) break;
+            if (startParallelJob(&jobs[j], template, path, line, inputFile == NULL) < 0) {
+                failed++;
+            } else {
+                running++;
+            }
+        }
+        if (running == 0) break;
+
+        int nFds = 0;
+        for (long j = 0; j < maxJobs; j++) {
+            if (jobs[j].fd < 0) continue;
+            fds[nFds] = (struct pollfd){jobs[j].fd, POLLIN, 0};
+            slotOf[nFds++] = j;
+        }
+        if (poll(fds, nFds, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            break;
+        }
+
+        for (int f = 0; f < nFds; f++) {
+            if (fds[f].revents == 0) continue;
+            ParallelJob *job = &jobs[slotOf[f]];
+            if (job->cap - job->length < 65536) {
+                job->cap = job->cap ? job->cap * 2 : 65536;
+                if ((job->output = (char *) realloc(job->output, job->cap)) == NULL) {
+                    perror("Memory allocation faild");
+                    exit(EXIT_FAILURE);
                 }
+            }
+            ssize_t n = read(job->fd, job->output + job->length, job->cap - job->length);
+            if (n > 0) {
+                job->length += n;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
 
-                if (value != NULL) {
-                    free(token);
-                    token = strdup(value);
-                    if (token == NULL) {
-                        perror("Memory allocation faild");
-                        exit(EXIT_FAILURE);
-                    }
-                } else {
-                    token = " ";
+            // End of output: the job is done (or about to be), collect it and print its output whole.
+            close(job->fd);
+            job->fd = -1;
+            running--;
+            int childStatus;
+            if (waitpid(job->pid, &childStatus, 0) < 0 || !WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0) {
+                failed++;
+            }
+            for (size_t done = 0; done < job->length;) {
+                ssize_t written = write(STDOUT_FILENO, job->output + done, job->length - done);
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    break;
                 }
+                done += written;
             }
-            // Handle redirection
-            if (strcmp(token, ">") == 0 || strcmp(token, "<") == 0 || strcmp(token, "2>") == 0) {
-                // Determine redirection type
-                int is_stdout = (strcmp(token, ">") == 0);
-                int is_stdin = (strcmp(token, "<") == 0);
-                int is_stderr = (strcmp(token, "2>") == 0);
-                free(token);  // Free the token now
-
-                // Extract filename
-                while (buff[j] == ' ') j++;
-                i = j;
-                while (buff[j] != ' ' && buff[j] != '\0') j++;
-                int fnameLen = j - i;
-                char *filename = malloc(fnameLen + 1);
-                strncpy(filename, buff + i, fnameLen);
-                filename[fnameLen] = '\0';
-
-                // Assign to appropriate field
-                if (is_stdout) {
-                    cmd->stdoutFile = filename;
-                } else if (is_stdin) {
-                    cmd->stdinFile = filename;
-                } else if (is_stderr) {
-                    cmd->stderrFile = filename;
+        }
+    }
+
+    for (long j = 0; j < maxJobs; j++) free(jobs[j].output);
+    free(jobs);
+    free(fds);
+    free(slotOf);
+    free(input.data);
+    if (inputFile != NULL) close(input.fd);
+    return failed > 101 ? 101 : failed;
+}
+
+// Helper Functions for glob expansion.
+
+// Compile one path component (no '/') into match operations. Returns -1 if out of memory.
+int globCompile(const char *pattern, GlobPattern *glob) {
+    size_t len = strlen(pattern);
+    glob->ops = (GlobOp *) malloc((len + 1) * sizeof(GlobOp));  // At most one op per byte.
+    glob->nOps = 0;
+    glob->matchHidden = pattern[0] == '.';
+    if (glob->ops == NULL) return -1;
+
+    const char *p = pattern;
+    while (*p) {
+        GlobOp *op = &glob->ops[glob->nOps];
+        if (*p == '*') {
+            while (*p == '*') p++;  // `**` is the same as `*` here.
+            op->kind = GLOB_STAR;
+        } else if (*p == '?') {
+            p++;
+            op->kind = GLOB_ANY;
+        } else if (*p == '[' && p[1] != '\0' && p[2] != '\0') {
+            // [abc], [a-z], [!x] / [^x]; a ']' right after the '[' (or '!') is a literal.
+            // The class must close before the end of the component.
+            const char *c = p + 1;
+            int negate = *c == '!' || *c == '^';
+            if (negate) c++;
+            memset(op->set, 0, sizeof(op->set));
+            if (*c != '\0') do {
+                unsigned char from = *c, to = *c;
+                if (c[1] == '-' && c[2] != ']' && c[2] != '\0') {
+                    to = c[2];
+                    c += 2;
                 }
+                for (unsigned int b = from; b <= to; b++) op->set[b >> 3] |= 1 << (b & 7);
+                c++;
+            } while (*c != ']' && *c != '\0');
+            if (*c != ']') {  // Unterminated after all: the '[' is a plain byte.
+                op->kind = GLOB_LITERAL;
+                op->text = p++;
+                op->len = 1;
+                glob->nOps++;
                 continue;
             }
-            // Handle inline redirection (e.g. >out.txt)
-            else if (strncmp(token, "2>", 2) == 0) {
-                cmd->stderrFile = strdup(token + 2);
-                free(token);
-                continue;
-            } else if (token[0] == '>') {
-                cmd->stdoutFile = strdup(token + 1);
-                free(token);
-                continue;
-            } else if (token[0] == '<') {
-                cmd->stdinFile = strdup(token + 1);
-                free(token);
-                continue;
+            if (negate) {
+                for (int i = 0; i < 32; i++) op->set[i] = ~op->set[i];
             }
-            if (!cmd->command) {
-                cmd->command = strdup(token);
-                if (!cmd->command) {
-                    printf("Command Mem Allocation Faild!!\n");
-                    exit(EXIT_FAILURE);
+            op->kind = GLOB_CLASS;
+            p = c + 1;
+        } else {
+            // Merge plain bytes into one run, compared with memcmp().
+            op->kind = GLOB_LITERAL;
+            op->text = p;
+            op->len = 1;
+            while (p[op->len] != '\0' && strchr("*?[", p[op->len]) == NULL) op->len++;
+            p += op->len;
+        }
+        glob->nOps++;
+    }
+    return 0;
+}
+
+// Match a directory entry name against a compiled component (greedy `*` with backtracking).
+int globMatch(const GlobPattern *glob, const char *name) {
+    if (name[0] == '.' && !glob->matchHidden) return 0;
+    size_t nameLen = strlen(name);
+    size_t pos = 0;
+    int op = 0;
+    int starOp = -1;    // Op after the last `*` seen...
+    size_t starPos = 0;  // ...and where in the name that `*` currently stops.
+
+    while (op < glob->nOps || pos < nameLen) {
+        if (op < glob->nOps) {
+            const GlobOp *o = &glob->ops[op];
+            switch (o->kind) {
+                case GLOB_STAR:
+                    starOp = ++op;
+                    starPos = pos;
+                    continue;
+                case GLOB_ANY:
+                    if (pos < nameLen) {
+                        op++;
+                        pos++;
+                        continue;
+                    }
+                    break;
+                case GLOB_CLASS: {
+                    unsigned char c = name[pos];
+                    if (pos < nameLen && (o->set[c >> 3] & (1 << (c & 7)))) {
+                        op++;
+                        pos++;
+                        continue;
+                    }
+                    break;
                 }
+                case GLOB_LITERAL:
+                    if (nameLen - pos >= o->len && memcmp(name + pos, o->text, o->len) == 0) {
+                        op++;
+                        pos += o->len;
+                        continue;
+                    }
+                    break;
             }
+        }
+        // Mismatch: let the last `*` swallow one more byte, or fail.
+        if (starOp < 0 || starPos >= nameLen) return 0;
+        op = starOp;
+        pos = ++starPos;
+    }
+    return 1;
+}
+
+static int isDirectory(const char *path, unsigned char type) {
+    if (type == DT_DIR) return 1;
+    if (type != DT_UNKNOWN && type != DT_LNK) return 0;
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static void pathListAdd(PathList *list, char *path) {
+    if (list->count == list->cap) {
+        list->cap = list->cap ? list->cap * 2 : 64;
+        if ((list->items = (char **) realloc(list->items, list->cap * sizeof(char *))) == NULL) {
+            perror("Memory allocation faild");
+            exit(EXIT_FAILURE);
+        }
+    }
+    list->items[list->count++] = path;
+}
 
-            cmd->argArr[count++] = strdup(token);
+// "dir" + "/" + "name" in the line arena ("" means the current directory).
+static char *joinPath(const char *dir, const char *name, size_t nameLen) {
+    size_t dirLen = strlen(dir);
+    int slash = dirLen > 0 && dir[dirLen - 1] != '/';
+    char *path = arenaAlloc(&lineArena, dirLen + slash + nameLen + 1);
+    if (path == NULL) {
+        perror("Memory allocation faild");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(path, dir, dirLen);
+    if (slash) path[dirLen] = '/';
+    memcpy(path + dirLen + slash, name, nameLen);
+    path[dirLen + slash + nameLen] = '\0';
+    return path;
+}
+
+// Add every entry of dir matching glob to out, read with getdents64() a megabyte at a time.
+static void globScanDir(const char *dir, const GlobPattern *glob, int wantDir, PathList *out) {
+    static char *entries = NULL;
+    const size_t entriesSize = 1 << 20;
+    if (entries == NULL && (entries = (char *) malloc(entriesSize)) == NULL) return;
+
+    int fd = open(dir[0] ? dir : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return;  // Unreadable directories just match nothing.
+    long n;
+    while ((n = syscall(SYS_getdents64, fd, entries, entriesSize)) > 0) {
+        for (long offset = 0; offset < n;) {
+            struct linux_dirent64 *entry = (struct linux_dirent64 *) (entries + offset);
+            offset += entry->d_reclen;
+            const char *name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+            if (!globMatch(glob, name)) continue;
+            char *path = joinPath(dir, name, strlen(name));
+            if (wantDir && !isDirectory(path, entry->d_type)) continue;
+            pathListAdd(out, path);
         }
-        // Skip spaces between words
-        while (buff[j] == ' ') j++;
     }
+    close(fd);
+}
+
+// Expand a word holding `*`, `?` or `[...]` (in any path component) into the sorted matching
+// paths. A pattern that matches nothing is passed on unchanged, like sh.
+void globExpand(char *pattern, ParsedCommand *cmd) {
+    PathList current = {NULL, 0, 0}, next = {NULL, 0, 0};
+    int trailingSlash = pattern[strlen(pattern) - 1] == '/';
+    int globbed = 0;      // A glob component has been matched against a directory...
+    int checkExists = 0;  // ...and literal components after it still have to exist.
+    pathListAdd(&current, pattern[0] == '/' ? "/" : "");
 
-    cmd->argArr[count] = NULL;  // Null-terminate the array
+    // Walk the components, `current` holds the paths matched so far.
+    char *copy = arenaStrdup(&lineArena, pattern);
+    char *save = NULL;
+    char *component = strtok_r(copy, "/", &save);
+    while (component != NULL && current.count > 0) {
+        char *following = strtok_r(NULL, "/", &save);
+        int wantDir = following != NULL || trailingSlash;
+        next.count = 0;
+        if (strpbrk(component, "*?[") == NULL) {
+            for (size_t i = 0; i < current.count; i++) {
+                pathListAdd(&next, joinPath(current.items[i], component, strlen(component)));
+            }
+            checkExists = globbed;
+        } else {
+            GlobPattern glob;
+            if (globCompile(component, &glob) == 0) {
+                for (size_t i = 0; i < current.count; i++) globScanDir(current.items[i], &glob, wantDir, &next);
+            }
+            free(glob.ops);
+            globbed = 1;
+            checkExists = 0;  // globScanDir() only returns entries that exist.
+        }
+        PathList swap = current;
+        current = next;
+        next = swap;
+        component = following;
+    }
+
+    size_t matched = 0;
+    for (size_t i = 0; i < current.count; i++) {
+        struct stat st;
+        if (checkExists && lstat(current.items[i], &st) != 0) continue;
+        current.items[matched++] = current.items[i];
+    }
+    if (matched == 0) {
+        addArg(cmd, pattern);
+    } else {
+        sortStrings(current.items, matched);
+        for (size_t i = 0; i < matched; i++) {
+            addArg(cmd, trailingSlash ? joinPath(current.items[i], "", 0) : current.items[i]);
+        }
+    }
+    free(current.items);
+    free(next.items);
+}
+
+// Helper Functions for sorting glob results (threads for big lists).
+
+#define PARALLEL_SORT_MIN 65536  // Below this a single qsort() is faster than starting threads.
+#define PARALLEL_SORT_MAX_RUNS 16
+
+typedef struct {
+    char **src;
+    char **dst;
+    size_t lo, mid, hi;
+} SortTask;
+
+static int compareStrings(const void *a, const void *b) { return strcmp(*(char *const *) a, *(char *const *) b); }
+
+static void *sortRun(void *arg) {
+    SortTask *task = (SortTask *) arg;
+    qsort(task->src + task->lo, task->hi - task->lo, sizeof(char *), compareStrings);
+    return NULL;
+}
+
+// Merge the sorted runs src[lo, mid) and src[mid, hi) into dst[lo, hi).
+static void *mergeRuns(void *arg) {
+    SortTask *task = (SortTask *) arg;
+    size_t i = task->lo, j = task->mid, k = task->lo;
+    while (i < task->mid && j < task->hi) {
+        task->dst[k++] = strcmp(task->src[i], task->src[j]) <= 0 ? task->src[i++] : task->src[j++];
+    }
+    while (i < task->mid) task->dst[k++] = task->src[i++];
+    while (j < task->hi) task->dst[k++] = task->src[j++];
+    return NULL;
+}
+
+// Run every task on its own thread (inline if a thread can't be created) and wait for all of them.
+static void runTasks(void *(*fn)(void *), SortTask *tasks, int nTasks) {
+    pthread_t threads[PARALLEL_SORT_MAX_RUNS];
+    int started[PARALLEL_SORT_MAX_RUNS];
+    for (int t = 0; t < nTasks; t++) {
+        started[t] = pthread_create(&threads[t], NULL, fn, &tasks[t]) == 0;
+        if (!started[t]) fn(&tasks[t]);
+    }
+    for (int t = 0; t < nTasks; t++) {
+        if (started[t]) pthread_join(threads[t], NULL);
+    }
+}
+
+// Sort strings by bytes: one qsort() for small lists, otherwise one run per core sorted in
+// parallel and merged pairwise (each merge pass in parallel too).
+void sortStrings(char **strings, size_t count) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int runs = 1;
+    while (runs * 2 <= cores && runs * 2 <= PARALLEL_SORT_MAX_RUNS) runs *= 2;
+    char **spare = count >= PARALLEL_SORT_MIN && runs > 1 ? (char **) malloc(count * sizeof(char *)) : NULL;
+    if (spare == NULL) {
+        qsort(strings, count, sizeof(char *), compareStrings);
+        return;
+    }
+
+    size_t bounds[PARALLEL_SORT_MAX_RUNS + 1];
+    for (int r = 0; r <= runs; r++) bounds[r] = count * r / runs;
+    SortTask tasks[PARALLEL_SORT_MAX_RUNS];
+    for (int r = 0; r < runs; r++) tasks[r] = (SortTask){strings, NULL, bounds[r], 0, bounds[r + 1]};
+    runTasks(sortRun, tasks, runs);
+
+    char **src = strings, **dst = spare;
+    for (int width = 1; width < runs; width *= 2) {
+        int nTasks = 0;
+        for (int r = 0; r < runs; r += 2 * width) {
+            tasks[nTasks++] = (SortTask){src, dst, bounds[r], bounds[r + width], bounds[r + 2 * width]};
+        }
+        runTasks(mergeRuns, tasks, nTasks);
+        char **swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != strings) memcpy(strings, src, count * sizeof(char *));
+    free(spare);
 }
 
 // built-in `echo` command function definition.
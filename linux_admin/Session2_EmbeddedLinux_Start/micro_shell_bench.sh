@@ -0,0 +1,175 @@
+#!/usr/bin/bash
+# Benchmarks for micro_shell.c. Builds the shell from the source next to this script,
+# runs generated scripts through it and through bash, and prints the timings.
+#
+# Usage: ./micro_shell_bench.sh BENCH [SIZE]
+#   pipeline [MiB]   cat | tr | wc throughput over SIZE MiB of text (default 256)
+#   spawn [N]        N lines of /bin/true, commands started per second (default 3000)
+#   vars [N]         set N variables, then read every one back and check it (default 1000000)
+#   copy [MiB]       builtin cp / cat against a read/write loop (dd) and /bin/cp, on a SIZE MiB
+#                    file (default 512) and on 2000 files of 4 KiB
+#   parallel [N]     builtin parallel against the same jobs run one at a time: N x sleep 0.1
+#                    (default 64) and 50 x N x /bin/true
+#   parse [N]        --bench-parse over a generated corpus of N command lines (default 200000):
+#                    quoting, variables, assignments, pipelines, redirections, globs, long lines
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+WORK_DIR="$(mktemp -d)"
+MICRO="$WORK_DIR/micro"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+# Wall time of a command in milliseconds, its output thrown away.
+function elapsed_ms(){
+    local start=$(date +%s%N)
+    "$@" > /dev/null 2>&1
+    local end=$(date +%s%N)
+    echo $(( (end - start) / 1000000 ))
+}
+
+# Run the same script through micro_shell and bash, print both times and the rate.
+# $1: label, $2: script, $3: amount of work, $4: unit of the rate.
+function compare(){
+    local micro_ms=$(elapsed_ms "$MICRO" "$2")
+    local bash_ms=$(elapsed_ms bash "$2")
+    (( micro_ms == 0 )) && micro_ms=1
+    (( bash_ms == 0 )) && bash_ms=1
+    printf "%-28s micro_shell %6d ms (%d %s)   bash %6d ms (%d %s)\n" "$1" \
+        "$micro_ms" $(( $3 * 1000 / micro_ms )) "$4" "$bash_ms" $(( $3 * 1000 / bash_ms )) "$4"
+}
+
+# Time a micro_shell script on its own, $3 MiB of data moved.
+function time_script(){
+    local ms=$(elapsed_ms "$MICRO" "$2")
+    (( ms == 0 )) && ms=1
+    printf "%-40s %6d ms (%d MiB/s)\n" "$1" "$ms" $(( $3 * 1000 / ms ))
+}
+
+function bench_pipeline(){
+    local mib=${1:-256}
+    base64 /dev/urandom | head -c $(( mib * 1024 * 1024 )) > "$WORK_DIR/data"
+    echo "cat $WORK_DIR/data | tr a-z A-Z | wc -c" > "$WORK_DIR/pipeline.sh"
+    compare "cat | tr | wc, $mib MiB" "$WORK_DIR/pipeline.sh" "$mib" "MiB/s"
+}
+
+function bench_spawn(){
+    local count=${1:-3000}
+    yes /bin/true | head -n "$count" > "$WORK_DIR/spawn.sh"
+    compare "$count x /bin/true" "$WORK_DIR/spawn.sh" "$count" "commands/s"
+}
+
+function bench_vars(){
+    local count=${1:-1000000}
+    awk -v n="$count" 'BEGIN { for (i = 1; i <= n; i++) print "v" i "=value" i
+                               for (i = 1; i <= n; i++) print "echo $v" i }' > "$WORK_DIR/vars.sh"
+    compare "$count variables set + read" "$WORK_DIR/vars.sh" "$count" "variables/s"
+
+    # micro_shell's echo ends every argument with a space, drop it before comparing.
+    "$MICRO" "$WORK_DIR/vars.sh" | sed 's/ $//' > "$WORK_DIR/vars.out"
+    if awk -v n="$count" 'BEGIN { for (i = 1; i <= n; i++) print "value" i }' | cmp -s - "$WORK_DIR/vars.out"; then
+        echo "all $count values read back correctly"
+    else
+        echo "ERROR:: micro_shell read back wrong values"
+        return 1
+    fi
+}
+
+function bench_copy(){
+    local mib=${1:-512}
+    local src="$WORK_DIR/big" dst="$WORK_DIR/big.copy"
+    head -c $(( mib * 1024 * 1024 )) /dev/urandom > "$src"
+
+    echo "cp $src $dst" > "$WORK_DIR/copy.sh"
+    time_script "builtin cp, $mib MiB" "$WORK_DIR/copy.sh" "$mib"
+    echo "cat $src > $dst" > "$WORK_DIR/copy.sh"
+    time_script "builtin cat > file, $mib MiB" "$WORK_DIR/copy.sh" "$mib"
+    echo "dd if=$src of=$dst bs=64K" > "$WORK_DIR/copy.sh"
+    time_script "read/write loop (dd bs=64K), $mib MiB" "$WORK_DIR/copy.sh" "$mib"
+    echo "/bin/cp $src $dst" > "$WORK_DIR/copy.sh"
+    time_script "/bin/cp, $mib MiB" "$WORK_DIR/copy.sh" "$mib"
+    rm -f "$src" "$dst"
+
+    # Small files: the builtin saves a process start per file.
+    mkdir -p "$WORK_DIR/small" "$WORK_DIR/small.copy"
+    for i in $(seq 2000); do head -c 4096 /dev/urandom > "$WORK_DIR/small/$i"; done
+    local small_mib=$(( 2000 * 4 / 1024 ))
+    for tool in cp /bin/cp; do
+        for i in $(seq 2000); do echo "$tool $WORK_DIR/small/$i $WORK_DIR/small.copy/$i"; done > "$WORK_DIR/copy.sh"
+        time_script "$tool x 2000 files of 4 KiB" "$WORK_DIR/copy.sh" "$small_mib"
+    done
+}
+
+function bench_parallel(){
+    local count=${1:-64}
+    yes 0.1 | head -n "$count" > "$WORK_DIR/sleeps"
+    for jobs in 1 4 16; do
+        echo "parallel -j $jobs -a $WORK_DIR/sleeps sleep" > "$WORK_DIR/parallel.sh"
+        local ms=$(elapsed_ms "$MICRO" "$WORK_DIR/parallel.sh")
+        printf "%-40s %6d ms\n" "$count x sleep 0.1, -j $jobs" "$ms"
+    done
+    echo "while read t; do sleep \$t; done < $WORK_DIR/sleeps" > "$WORK_DIR/sequential.sh"
+    printf "%-40s %6d ms\n" "$count x sleep 0.1, bash loop" "$(elapsed_ms bash "$WORK_DIR/sequential.sh")"
+
+    # Short jobs: what the job bookkeeping costs next to starting the same programs in a script.
+    local trues=$(( count * 50 ))
+    seq "$trues" > "$WORK_DIR/lines"
+    echo "parallel -j $(nproc) -a $WORK_DIR/lines /bin/true" > "$WORK_DIR/parallel.sh"
+    yes /bin/true | head -n "$trues" > "$WORK_DIR/sequential.sh"
+    local parallel_ms=$(elapsed_ms "$MICRO" "$WORK_DIR/parallel.sh")
+    local sequential_ms=$(elapsed_ms "$MICRO" "$WORK_DIR/sequential.sh")
+    (( parallel_ms == 0 )) && parallel_ms=1
+    (( sequential_ms == 0 )) && sequential_ms=1
+    printf "%-40s %6d ms (%d commands/s)\n" "$trues x /bin/true, parallel -j $(nproc)" \
+        "$parallel_ms" $(( trues * 1000 / parallel_ms ))
+    printf "%-40s %6d ms (%d commands/s)\n" "$trues x /bin/true, one per line" \
+        "$sequential_ms" $(( trues * 1000 / sequential_ms ))
+}
+
+# The same corpus on every run (fixed seed): plain commands, quoted words, variables,
+# assignments, pipelines, redirections, a glob every 100 lines and every 20th line a long one.
+function parse_corpus(){
+    awk -v n="$1" 'BEGIN {
+        srand(42)
+        split("ls cat grep sort make git echo find cp tar", cmds, " ")
+        for (i = 1; i <= n; i++) {
+            c = cmds[int(rand() * 10) + 1]
+            kind = i % 20 == 0 ? 9 : i % 100 == 50 ? 8 : int(rand() * 8)
+            if (kind == 0) print c " -l /usr/lib/x86_64-linux-gnu/lib" i ".so --color=auto"
+            else if (kind == 1) print "echo \"hello world " i "\" '"'"'single quoted'"'"' \"a\\\"b\" \"$HOME/x\""
+            else if (kind == 2) print "echo $HOME $PATH $? $undefined_" i " $v" i % 100
+            else if (kind == 3) print "v" i % 100 "=value" i
+            else if (kind == 4) print "cat file" i ".txt | grep -v \"#\" | sort | uniq -c | sort -rn | head -n 10"
+            else if (kind == 5) print "sort < in" i ".txt > out" i ".txt 2> err.txt"
+            else if (kind == 6) print c " >build" i ".log 2>build.err <input"
+            else if (kind == 7) print c " --opt=" i " -x -y -z a/b/c/d"
+            else if (kind == 8) print "ls *.sh ?orpus [ab]*.txt"
+            else {
+                line = c
+                for (j = 0; j < 100 + i % 200; j++) line = line " arg" j "_" i
+                print line
+            }
+        }
+    }'
+}
+
+function bench_parse(){
+    local count=${1:-200000}
+    parse_corpus "$count" > "$WORK_DIR/corpus"
+    echo "corpus: $count lines, $(( $(stat -c %s "$WORK_DIR/corpus") / 1024 )) KiB"
+    # Globs in the corpus match against the (nearly empty) work directory.
+    (cd "$WORK_DIR" && "$MICRO" --bench-parse corpus)
+}
+
+case "$1" in
+    pipeline | spawn | vars | copy | parallel | parse) ;;
+    *)
+        sed -n '5,/^$/s/^# \?//p' "$0"
+        exit 1
+        ;;
+esac
+
+if ! gcc -Wall -O2 "$SCRIPT_DIR/micro_shell.c" -o "$MICRO" -pthread 2> "$WORK_DIR/build.log"; then
+    echo "ERROR:: micro_shell.c does not build"
+    cat "$WORK_DIR/build.log"
+    exit 1
+fi
+"bench_$1" "$2"